@@ -0,0 +1,64 @@
+#!/usr/bin/env bash
+# Times builds of ch8asm against each other and prints one JSON object per
+# build and workload, with the speedup over the first build:
+#   bench/build_bench.sh corpus_gen workdir name=ch8asm...
+# The workloads are a batch of small generated programs and one large
+# source, single threaded, best of five runs. Both have to assemble, a run
+# that fails stops the benchmark.
+
+set -e
+gen=$1
+work=$2
+shift 2
+mkdir -p "$work"
+
+rm -f "$work/manifest.txt"
+for seed in $(seq 1 2000); do
+  "$gen" -s $((1000 + seed % 200 * 40)) -r $((seed + 1000)) \
+    > "$work/small$seed.asm"
+  echo "$work/small$seed.asm $work/small$seed.bin" >> "$work/manifest.txt"
+done
+# A ROM holds a 48 KB program at most, so the large source pads one with
+# constants and comments to about 16 MB
+"$gen" -s 48000 -r 1000 | awk -v lines=70 -f "$(dirname "$0")/pad.awk" \
+  > "$work/large.asm"
+
+# best of five, in nanoseconds
+best() {
+  local best=""
+  for run in 1 2 3 4 5; do
+    local start=$(date +%s%N)
+    local status=0
+    "$@" > /dev/null 2>&1 || status=$?
+    local elapsed=$(( $(date +%s%N) - start ))
+    if [ $status -ne 0 ]; then
+      echo "$* failed with exit code $status" >&2
+      return 1
+    fi
+    if [ -z "$best" ] || [ $elapsed -lt $best ]; then
+      best=$elapsed
+    fi
+  done
+  echo $best
+}
+
+declare -A baseline
+for build in "$@"; do
+  name=${build%%=*}
+  exec=${build#*=}
+  for workload in batch large; do
+    if [ $workload == batch ]; then
+      ns=$(best "$exec" -j 1 --batch "@$work/manifest.txt")
+    else
+      ns=$(best "$exec" -j 1 "$work/large.asm" "$work/large.bin")
+    fi
+    if [ -z "${baseline[$workload]}" ]; then
+      baseline[$workload]=$ns
+    fi
+    awk -v name=$name -v workload=$workload -v ns=$ns \
+      -v base=${baseline[$workload]} 'BEGIN {
+        printf "{\"build\": \"%s\", \"workload\": \"%s\", \"seconds\": %.4f, ", name, workload, ns / 1e9
+        printf "\"speedup\": %.3f}\n", base / ns
+      }'
+  done
+done
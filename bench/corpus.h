@@ -0,0 +1,135 @@
+#pragma once
+
+// Synthetic sources for the benchmarks (see suite_bench.cpp and
+// corpus_gen.cpp). They always assemble without errors, apart from not
+// fitting into a ROM once they are large.
+
+#include <random>
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+
+typedef struct {
+    size_t size;     // bytes, the last line may go a little over
+    double labels;   // share of lines that define a label
+    double comments; // share of lines that are or end in a comment
+    double binary;   // share of literals written in binary instead of hex
+    unsigned seed;
+} CorpusOptions;
+
+inline CorpusOptions defaultCorpus() {
+    return {16 << 20, 0.1, 0.3, 0.25, 1};
+}
+
+// identifiers can not contain digits, so n is spelled with 'a' to 'j'
+inline const char *corpusName(char *text, const char *prefix, int n) {
+    char digits[16];
+    int length = snprintf(digits, sizeof(digits), "%d", n);
+    int p = snprintf(text, 32, "%s", prefix);
+    for (int i = 0; i < length; i++)
+        text[p++] = 'a' + digits[i] - '0';
+    text[p] = '\0';
+    return text;
+}
+
+inline std::string generateCorpus(const CorpusOptions &options) {
+    static const char *comments[] = {
+        "; generated by corpus_gen, do not edit",
+        "; draw the next frame before the timer runs out",
+        "; ----------------------------------------------",
+    };
+    std::mt19937 random(options.seed);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    auto pick = [&](int n) { return (int)(random() % n); };
+
+    std::string source;
+    source.reserve(options.size + 256);
+    char line[128];
+    char name[32];
+    int labels = 0;     // defined so far, named la, lb, ...
+    int referenced = 0; // one past the highest label referenced
+    int variables = 0;  // assigned so far, named vara, varb, ...
+
+    char text[24]; // of the last literal, one per call for the threads
+    auto literal = [&](int bits) {
+        int value = random() & ((1 << bits) - 1);
+        if (chance(random) < options.binary) {
+            text[0] = '%';
+            for (int i = 0; i < bits; i++)
+                text[1 + i] = (value >> (bits - 1 - i)) & 1 ? '1' : '0';
+            text[1 + bits] = '\0';
+        } else {
+            snprintf(text, sizeof(text), "$%0*X", bits / 4, value);
+        }
+        return text;
+    };
+    // up to a few labels ahead, so some references are forward ones
+    auto label = [&]() {
+        int target = pick(labels + 4);
+        if (target + 1 > referenced)
+            referenced = target + 1;
+        return corpusName(name, "l", target);
+    };
+
+    while (source.size() < options.size) {
+        double kind = chance(random);
+        if (kind < options.labels) {
+            snprintf(line, sizeof(line), "%s:",
+                     corpusName(name, "l", labels++));
+        } else if (kind < options.labels + options.comments / 2) {
+            snprintf(line, sizeof(line), "%s", comments[pick(3)]);
+        } else if (kind < options.labels + options.comments / 2 + 0.02) {
+            snprintf(line, sizeof(line), "%s = %s",
+                     corpusName(name, "var", variables++), literal(8));
+        } else {
+            int x = pick(16), y = pick(16);
+            switch (pick(8)) {
+                case 0:
+                    snprintf(line, sizeof(line), "    JP %s", label());
+                    break;
+                case 1:
+                    snprintf(line, sizeof(line), "    CALL %s", label());
+                    break;
+                case 2:
+                    snprintf(line, sizeof(line), "    LD I, %s", label());
+                    break;
+                case 3:
+                    if (variables > 0 && pick(2) == 0)
+                        snprintf(line, sizeof(line), "    LD V%X, %s", x,
+                                 corpusName(name, "var", pick(variables)));
+                    else
+                        snprintf(line, sizeof(line), "    LD V%X, %s", x,
+                                 literal(8));
+                    break;
+                case 4:
+                    snprintf(line, sizeof(line), "    ADD V%X, V%X", x, y);
+                    break;
+                case 5:
+                    snprintf(line, sizeof(line), "    SE V%X, %s", x,
+                             literal(8));
+                    break;
+                case 6:
+                    snprintf(line, sizeof(line), "    DRW V%X, V%X, %s", x, y,
+                             literal(4));
+                    break;
+                default:
+                    snprintf(line, sizeof(line), "    CLS");
+                    break;
+            }
+            if (chance(random) < options.comments / 2) {
+                source += line;
+                snprintf(line, sizeof(line), " %s", comments[pick(3)]);
+            }
+        }
+        source += line;
+        source += '\n';
+    }
+
+    // forward references past the end still need their labels
+    while (labels < referenced) {
+        snprintf(line, sizeof(line), "%s:\n",
+                 corpusName(name, "l", labels++));
+        source += line;
+    }
+    return source;
+}
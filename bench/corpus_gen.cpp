@@ -0,0 +1,33 @@
+// Writes a synthetic source to standard output, e.g. for timing ch8asm.x
+// itself: corpus_gen.x [-s bytes] [-l labels] [-c comments] [-b binary]
+// [-r seed], with the shares between 0 and 1 (see corpus.h).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "corpus.h"
+
+int main(int argc, char *argv[]) {
+    CorpusOptions options = defaultCorpus();
+    for (int arg = 1; arg + 1 < argc; arg += 2) {
+        const char *value = argv[arg + 1];
+        if (strcmp(argv[arg], "-s") == 0) {
+            options.size = strtoull(value, nullptr, 10);
+        } else if (strcmp(argv[arg], "-l") == 0) {
+            options.labels = atof(value);
+        } else if (strcmp(argv[arg], "-c") == 0) {
+            options.comments = atof(value);
+        } else if (strcmp(argv[arg], "-b") == 0) {
+            options.binary = atof(value);
+        } else if (strcmp(argv[arg], "-r") == 0) {
+            options.seed = atoi(value);
+        } else {
+            fprintf(stderr, "Unknown option \"%s\".\n", argv[arg]);
+            return 64;
+        }
+    }
+    std::string source = generateCorpus(options);
+    fwrite(source.data(), 1, source.size(), stdout);
+    return 0;
+}
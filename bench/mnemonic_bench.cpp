@@ -0,0 +1,205 @@
+// Compares the perfect-hash mnemonic lookup against the nested switch the
+// scanner used before, on a corpus of mnemonics, registers and labels.
+
+#include <chrono>
+#include <cstring>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "../src/mnemonic.h"
+#include "../src/token.h"
+
+typedef struct {
+    const char *start;
+    int length;
+} Word;
+
+static TokenType check(const char *text, int tokenLength, int start,
+                       int length, const char *rest, TokenType type) {
+    if (tokenLength == start + length &&
+        memcmp(text + start, rest, length) == 0) {
+        return type;
+    }
+
+    return TOKEN_IDENTIFIER;
+}
+
+static TokenType legacyClassify(const char *start, int len) {
+    if (len > 4)
+        return TOKEN_IDENTIFIER;
+
+    switch (start[0]) {
+        case 'A': {
+            switch (start[1]) {
+                case 'D': {
+                    return check(start, len, 2, 1, "D", TOKEN_INST_ADD);
+                } break;
+                case 'N': {
+                    return check(start, len, 2, 1, "D", TOKEN_INST_AND);
+                } break;
+            }
+        } break;
+        case 'B': {
+            return check(start, len, 1, 2, "CD", TOKEN_INST_BCD);
+        } break;
+        case 'C': {
+            switch (start[1]) {
+                case 'L': {
+                    return check(start, len, 2, 1, "S", TOKEN_INST_CLS);
+                } break;
+                case 'A': {
+                    return check(start, len, 2, 2, "LL", TOKEN_INST_CALL);
+                } break;
+            }
+        } break;
+        case 'D': {
+            return check(start, len, 1, 2, "RW", TOKEN_INST_DRW);
+        } break;
+        case 'F': {
+            return check(start, len, 1, 2, "NT", TOKEN_INST_FNT);
+        } break;
+        case 'G': {
+            return check(start, len, 1, 2, "DT", TOKEN_INST_GDT);
+        } break;
+        case 'J': {
+            if (len == 2) {
+                return check(start, len, 1, 1, "P", TOKEN_INST_JP);
+            } else {
+                return check(start, len, 1, 2, "PO", TOKEN_INST_JPO);
+            }
+        } break;
+        case 'L': {
+            if (len == 2) {
+                return check(start, len, 1, 1, "D", TOKEN_INST_LD);
+            } else {
+                return check(start, len, 1, 2, "DV", TOKEN_INST_LDV);
+            }
+        } break;
+        case 'O': {
+            return check(start, len, 1, 1, "R", TOKEN_INST_OR);
+        } break;
+        case 'R': {
+            switch (start[1]) {
+                case 'E': {
+                    return check(start, len, 2, 1, "T", TOKEN_INST_RET);
+                } break;
+                case 'N': {
+                    return check(start, len, 2, 1, "D", TOKEN_INST_RND);
+                }
+            }
+        } break;
+        case 'S': {
+            switch (start[1]) {
+                case 'U': {
+                    if (len == 3) {
+                        return check(start, len, 2, 1, "B", TOKEN_INST_SUB);
+                    } else {
+                        return check(start, len, 2, 2, "BN", TOKEN_INST_SUBN);
+                    }
+                } break;
+                case 'K': {
+                    if (len == 3) {
+                        return check(start, len, 2, 1, "P", TOKEN_INST_SKP);
+                    } else {
+                        return check(start, len, 2, 2, "NP", TOKEN_INST_SKNP);
+                    }
+                } break;
+                case 'H': {
+                    if (start[1] == 'H') {
+                        if (len == 3) {
+                            if (start[2] == 'L') {
+                                return TOKEN_INST_SHL;
+                            } else if (start[2] == 'R') {
+                                return TOKEN_INST_SHR;
+                            }
+                        }
+                    }
+                    return TOKEN_IDENTIFIER;
+                } break;
+                case 'E': {
+                    return check(start, len, 0, 2, "SE", TOKEN_INST_SE);
+                } break;
+                case 'N': {
+                    return check(start, len, 2, 1, "E", TOKEN_INST_SNE);
+                } break;
+                case 'D': {
+                    return check(start, len, 2, 1, "T", TOKEN_INST_SDT);
+                } break;
+                case 'S': {
+                    return check(start, len, 2, 1, "T", TOKEN_INST_SST);
+                } break;
+                case 'T': {
+                    return check(start, len, 2, 1, "V", TOKEN_INST_STV);
+                } break;
+            }
+        } break;
+        case 'W': {
+            return check(start, len, 1, 2, "KP", TOKEN_INST_WKP);
+        } break;
+        case 'X': {
+            return check(start, len, 1, 2, "OR", TOKEN_INST_XOR);
+        } break;
+    }
+
+    return TOKEN_IDENTIFIER;
+}
+
+static const char *words[] = {
+    "CLS",  "RET",  "JP",   "JPO",  "CALL", "SE",   "SNE",   "LD",
+    "ADD",  "AND",  "OR",   "XOR",  "SUB",  "SHR",  "SUBN",  "SHL",
+    "RND",  "DRW",  "SKP",  "SKNP", "GDT",  "WKP",  "SDT",   "SST",
+    "FNT",  "BCD",  "STV",  "LDV",  "loop", "draw", "sprite", "SHX",
+    "SEE",  "CAL",  "JPX",  "VAL",  "ADDR", "x",    "LDVX",  "mainloop",
+};
+
+typedef TokenType (*Classifier)(const char *start, int length);
+
+static double run(Classifier classify, const std::vector<Word> &corpus,
+                  int rounds, unsigned *checksum) {
+    auto begin = std::chrono::steady_clock::now();
+    unsigned sum = 0;
+    for (int r = 0; r < rounds; r++) {
+        for (const Word &word : corpus) {
+            sum += classify(word.start, word.length);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    *checksum = sum;
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+int main(int argc, char *argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 1 << 20;
+    int rounds = argc > 2 ? atoi(argv[2]) : 20;
+
+    // mostly mnemonics, like real sources where every line starts with one
+    std::vector<Word> corpus;
+    corpus.reserve(count);
+    srand(8);
+    int numWords = sizeof(words) / sizeof(words[0]);
+    for (int i = 0; i < count; i++) {
+        int pick = rand() % 4 == 0 ? rand() % numWords : rand() % 28;
+        corpus.push_back({words[pick], (int)strlen(words[pick])});
+    }
+
+    for (int i = 0; i < numWords; i++) {
+        int length = strlen(words[i]);
+        if (legacyClassify(words[i], length) !=
+            lookupInstruction(words[i], length)) {
+            fprintf(stderr, "Mismatch for '%s'.\n", words[i]);
+            return 1;
+        }
+    }
+
+    unsigned legacySum, hashSum;
+    double legacy = run(legacyClassify, corpus, rounds, &legacySum);
+    double hash = run(lookupInstruction, corpus, rounds, &hashSum);
+    double lookups = (double)count * rounds;
+
+    printf("switch:       %8.2f Mlookups/s\n", lookups / legacy / 1e6);
+    printf("perfect hash: %8.2f Mlookups/s\n", lookups / hash / 1e6);
+    printf("speedup:      %8.2fx (checksum %u/%u)\n", legacy / hash,
+           legacySum, hashSum);
+    return legacySum != hashSum;
+}
@@ -0,0 +1,27 @@
+# Pads a generated program that fits a ROM with lines that emit nothing, up
+# to the sizes that scanner and compiler throughput are measured on:
+#   corpus_gen.x -s 48000 | awk -v lines=70 [-v kind=labels] -f pad.awk
+# After each line of the program come that many constant definitions, each
+# followed by a comment line, or with kind=labels that many labels.
+
+function name(n,   text, digits, i) {
+  text = "k"
+  digits = n ""
+  for (i = 1; i <= length(digits); i++)
+    text = text substr("abcdefghij", substr(digits, i, 1) + 1, 1)
+  return text
+}
+
+{
+  print
+  for (i = 0; i < lines; i++) {
+    n++
+    if (kind == "labels") {
+      printf "%s:\n", name(n)
+    } else {
+      printf "%s = $%02X ; draw the next frame before the timer runs out\n",
+        name(n), n % 256
+      print "; ----------------------------------------------"
+    }
+  }
+}
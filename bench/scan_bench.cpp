@@ -0,0 +1,109 @@
+// Scanner throughput on a comment-heavy generated source, once with the
+// scalar loops, once per SIMD backend the CPU supports and then split
+// across threads.
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+
+#include "../src/arena.h"
+#include "../src/diagnostics.h"
+#include "../src/fastscan.h"
+#include "../src/parallelscan.h"
+#include "../src/symbols.h"
+#include "../src/token.h"
+
+static std::string generate(size_t size) {
+    static const char *lines[] = {
+        "; -----------------------------------------------------------------\n",
+        ";   generated sprite routine, do not edit by hand, see generator\n",
+        "loop:\n",
+        "    LD V1, $FF            ; reset the counter before drawing again\n",
+        "    DRW V0, V1, $5        ; draw the five byte tall digit sprite\n",
+        "    SE V2, %00001111      ; skip when all four low bits are set\n",
+        "\t\tJP loop              \t; and around we go\n",
+        "        \n",
+    };
+    int numLines = sizeof(lines) / sizeof(lines[0]);
+
+    std::string source;
+    source.reserve(size + 128);
+    srand(6);
+    while (source.size() < size) {
+        source += lines[rand() % numLines];
+    }
+    return source;
+}
+
+static double scan(const std::string &source, TokenList *tokens,
+                   ScanBackend backend, int threads) {
+    Arena arena;
+    SymbolTable symbols(&arena);
+    Diagnostics diagnostics;
+    tokens->clear();
+    auto begin = std::chrono::steady_clock::now();
+    scanSource(source.data(), source.size(), &symbols, tokens, &diagnostics,
+               threads, scanKernels(backend));
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+static bool sameTokens(const TokenList &a, const TokenList &b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].start != b[i].start || a[i].length != b[i].length ||
+            a[i].type != b[i].type || a[i].symbol != b[i].symbol)
+            return false;
+    }
+    return true;
+}
+
+static bool measure(const std::string &source, const TokenList &reference,
+                    int rounds, ScanBackend backend, int threads) {
+    Arena arena;
+    TokenList tokens(&arena);
+    tokens.reserve(reference.size());
+    double best = 1e9;
+    for (int r = 0; r < rounds; r++) {
+        double seconds = scan(source, &tokens, backend, threads);
+        best = seconds < best ? seconds : best;
+    }
+
+    if (!sameTokens(tokens, reference)) {
+        fprintf(stderr, "%s backend with %d threads produced different "
+                        "tokens.\n",
+                scanBackendName(backend), threads);
+        return false;
+    }
+    printf("%-7s %2d threads %8.1f MB/s %8.1f Mtokens/s\n",
+           scanBackendName(backend), threads, source.size() / best / 1e6,
+           tokens.size() / best / 1e6);
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    size_t size = argc > 1 ? atol(argv[1]) : 64 << 20;
+    int rounds = argc > 2 ? atoi(argv[2]) : 5;
+    std::string source = generate(size);
+
+    Arena arena;
+    TokenList reference(&arena);
+    scan(source, &reference, SCAN_SCALAR, 1);
+
+    ScanBackend best = detectScanBackend();
+    for (int b = SCAN_SCALAR; b <= best; b++) {
+        if (!measure(source, reference, rounds, (ScanBackend)b, 1))
+            return 1;
+    }
+
+    // always run a split scan, even on a single core, to check the output
+    int cores = std::thread::hardware_concurrency();
+    for (int threads = 2; threads <= (cores > 4 ? cores : 4); threads *= 2) {
+        if (!measure(source, reference, rounds, best, threads))
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,144 @@
+// Request latency of a small ROM through the assembler server, once over a
+// kept-open connection and once connecting per request, against starting a
+// ch8asm.x process per file. Needs ch8asm.x to be built.
+
+#include <algorithm>
+#include <chrono>
+#include <spawn.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../src/assembler.h"
+#include "../src/io.h"
+#include "../src/server.h"
+
+#define SOCKET_PATH "/tmp/ch8asm_serve_bench.sock"
+#define SOURCE_PATH "/tmp/ch8asm_serve_bench.asm"
+#define ROM_PATH "/tmp/ch8asm_serve_bench.bin"
+
+static const char *program = "start: CLS\n"
+                             "    LD V0, $00\n"
+                             "    LD V1, $0A\n"
+                             "    LD I, sprite\n"
+                             "loop: DRW V0, V1, $5\n"
+                             "    ADD V0, $05\n"
+                             "    SE V0, $3C\n"
+                             "    JP loop\n"
+                             "    JP start\n"
+                             "sprite: CLS\n";
+
+static double now() {
+    return std::chrono::duration<double>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static void report(const char *name, std::vector<double> *latencies) {
+    std::sort(latencies->begin(), latencies->end());
+    size_t count = latencies->size();
+    printf("%-24s p50 %8.1f us  p99 %8.1f us\n", name,
+           (*latencies)[count / 2] * 1e6, (*latencies)[count * 99 / 100] * 1e6);
+}
+
+static bool keptOpen(int requests, std::vector<double> *latencies) {
+    int fd = connectServer(SOCKET_PATH);
+    if (fd < 0)
+        return false;
+    for (int i = 0; i < requests; i++) {
+        Output output;
+        Diagnostics diagnostics;
+        std::vector<Dependency> dependencies;
+        AssembleStatus status;
+        double begin = now();
+        if (remoteAssemble(fd, "-", program, strlen(program), &output,
+                           &diagnostics, &dependencies,
+                           &status) != REMOTE_OK ||
+            status != ASSEMBLE_OK)
+            return false;
+        latencies->push_back(now() - begin);
+    }
+    close(fd);
+    return true;
+}
+
+static bool connectPerRequest(int requests, std::vector<double> *latencies) {
+    for (int i = 0; i < requests; i++) {
+        Output output;
+        Diagnostics diagnostics;
+        std::vector<Dependency> dependencies;
+        AssembleStatus status;
+        double begin = now();
+        int fd = connectServer(SOCKET_PATH);
+        if (fd < 0 ||
+            remoteAssemble(fd, "-", program, strlen(program), &output,
+                           &diagnostics, &dependencies,
+                           &status) != REMOTE_OK ||
+            status != ASSEMBLE_OK)
+            return false;
+        close(fd);
+        latencies->push_back(now() - begin);
+    }
+    return true;
+}
+
+static bool processPerFile(int requests, std::vector<double> *latencies) {
+    if (!writeRom(SOURCE_PATH, program, strlen(program)))
+        return false;
+    char *argv[] = {(char *)"./ch8asm.x", (char *)"-j", (char *)"1",
+                    (char *)SOURCE_PATH, (char *)ROM_PATH, nullptr};
+    for (int i = 0; i < requests; i++) {
+        double begin = now();
+        pid_t pid;
+        int status;
+        if (posix_spawn(&pid, argv[0], nullptr, nullptr, argv, environ) != 0 ||
+            waitpid(pid, &status, 0) < 0 || status != 0)
+            return false;
+        latencies->push_back(now() - begin);
+    }
+    return true;
+}
+
+int main() {
+    std::thread server(serve, SOCKET_PATH, 1);
+    server.detach();
+    // give the server a moment to bind
+    for (int tries = 0; tries < 100; tries++) {
+        int fd = connectServer(SOCKET_PATH);
+        if (fd >= 0) {
+            close(fd);
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    int requests = 2000;
+    std::vector<double> latencies;
+    if (!keptOpen(requests, &latencies)) {
+        fprintf(stderr, "Requests over one connection failed.\n");
+        return 1;
+    }
+    report("server, one connection", &latencies);
+
+    latencies.clear();
+    if (!connectPerRequest(requests, &latencies)) {
+        fprintf(stderr, "Requests with a connection each failed.\n");
+        return 1;
+    }
+    report("server, connect each", &latencies);
+
+    latencies.clear();
+    if (!processPerFile(requests / 10, &latencies)) {
+        fprintf(stderr, "Could not run ./ch8asm.x.\n");
+        return 1;
+    }
+    report("process per file", &latencies);
+
+    unlink(SOCKET_PATH);
+    unlink(SOURCE_PATH);
+    unlink(ROM_PATH);
+    return 0;
+}
@@ -0,0 +1,237 @@
+// The assembler's stages one by one on a generated corpus (see corpus.h),
+// best of a few rounds each. Prints one JSON object per line so runs can be
+// kept and compared:
+//   suite_bench.x [bytes] [rounds] [labels] [comments] [binary]
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "../src/arena.h"
+#include "../src/compiler.h"
+#include "../src/diagnostics.h"
+#include "../src/mnemonic.h"
+#include "../src/scanner.h"
+#include "../src/symbols.h"
+#include "../src/token.h"
+#include "corpus.h"
+
+typedef struct {
+    size_t bytes;
+    size_t tokens;
+    size_t instructions;
+} Work;
+
+static double seconds(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         begin)
+        .count();
+}
+
+static void report(const char *name, const Work &work, double best) {
+    printf("{\"bench\": \"%s\", \"bytes\": %zu, \"tokens\": %zu, "
+           "\"instructions\": %zu, \"seconds\": %.6f, \"mb_per_s\": %.1f, "
+           "\"tokens_per_s\": %.0f, \"instructions_per_s\": %.0f}\n",
+           name, work.bytes, work.tokens, work.instructions, best,
+           work.bytes / best / 1e6, work.tokens / best,
+           work.instructions / best);
+    fflush(stdout);
+}
+
+static bool isInstruction(const Token &token) {
+    return token.type >= TOKEN_INST_CLS && token.type <= TOKEN_INST_LDV;
+}
+
+static Work scanned(const std::string &source, const TokenList &tokens) {
+    Work work = {source.size(), tokens.size(), 0};
+    for (const Token &token : tokens) {
+        work.instructions += isInstruction(token);
+    }
+    return work;
+}
+
+static void scan(const std::string &source, SymbolTable *symbols,
+                 TokenList *tokens) {
+    Diagnostics diagnostics;
+    Scanner scanner(source.data(), source.size(), symbols, &diagnostics);
+    scanner.scan(tokens);
+    if (scanner.hadError) {
+        diagnostics.print(stderr);
+        exit(1);
+    }
+}
+
+static void benchScan(const std::string &source, int rounds) {
+    double best = 1e9;
+    Work work;
+    for (int r = 0; r < rounds; r++) {
+        Arena arena;
+        SymbolTable symbols(&arena);
+        TokenList tokens(&arena);
+        auto begin = std::chrono::steady_clock::now();
+        scan(source, &symbols, &tokens);
+        double elapsed = seconds(begin);
+        best = elapsed < best ? elapsed : best;
+        work = scanned(source, tokens);
+    }
+    report("scan", work, best);
+}
+
+// the words Scanner::identifierOrInstruction() classifies
+static void benchMnemonics(const std::string &source,
+                           const TokenList &tokens, int rounds) {
+    std::vector<Token> words;
+    Work work = {0, 0, 0};
+    for (const Token &token : tokens) {
+        if (token.type == TOKEN_IDENTIFIER || isInstruction(token)) {
+            words.push_back(token);
+            work.bytes += token.length;
+            work.instructions += isInstruction(token);
+        }
+    }
+    work.tokens = words.size();
+
+    double best = 1e9;
+    for (int r = 0; r < rounds; r++) {
+        size_t found = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (const Token &word : words) {
+            found += lookupInstruction(source.data() + word.start,
+                                       word.length) != TOKEN_IDENTIFIER;
+        }
+        double elapsed = seconds(begin);
+        best = elapsed < best ? elapsed : best;
+        if (found != work.instructions) {
+            fprintf(stderr, "Mnemonic lookup disagrees with the scanner.\n");
+            exit(1);
+        }
+    }
+    report("mnemonic", work, best);
+}
+
+// what Compiler::decodeLiteral() does once a literal has the right width
+static void benchLiterals(const std::string &source, const TokenList &tokens,
+                          int rounds) {
+    std::vector<Token> literals;
+    Work work = {0, 0, 0};
+    for (const Token &token : tokens) {
+        if (token.type == TOKEN_LITERAL) {
+            literals.push_back(token);
+            work.bytes += token.length;
+        }
+    }
+    work.tokens = literals.size();
+
+    double best = 1e9;
+    volatile uint32_t sink = 0;
+    for (int r = 0; r < rounds; r++) {
+        uint32_t sum = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (const Token &literal : literals) {
+            const char *start = source.data() + literal.start;
+            sum += *start == '%'
+                       ? decodeBinaryLiteral(start, literal.length)
+                       : decodeHexLiteral(start, literal.length);
+        }
+        double elapsed = seconds(begin);
+        best = elapsed < best ? elapsed : best;
+        sink = sink + sum;
+    }
+    report("literal", work, best);
+}
+
+// interning every identifier, the part of the label handling that does not
+// depend on the single pass (labels resolve through fixups in compile)
+static void benchSymbols(const std::string &source, const TokenList &tokens,
+                         int rounds) {
+    Work work = {0, 0, 0};
+    for (const Token &token : tokens) {
+        if (token.type == TOKEN_IDENTIFIER) {
+            work.bytes += token.length;
+            work.tokens++;
+        }
+    }
+
+    double best = 1e9;
+    for (int r = 0; r < rounds; r++) {
+        Arena arena;
+        SymbolTable symbols(&arena);
+        auto begin = std::chrono::steady_clock::now();
+        for (const Token &token : tokens) {
+            if (token.type == TOKEN_IDENTIFIER)
+                symbols.intern(source.data() + token.start, token.length);
+        }
+        double elapsed = seconds(begin);
+        best = elapsed < best ? elapsed : best;
+    }
+    report("symbols", work, best);
+}
+
+// Compiler::compile() on tokens that are already scanned, into a buffer
+// large enough that nothing is cut off at the ROM size
+static void benchCompile(const char *name, const std::string &source,
+                         int rounds) {
+    double best = 1e9;
+    Work work;
+    for (int r = 0; r < rounds; r++) {
+        Arena arena;
+        SymbolTable symbols(&arena);
+        TokenList tokens(&arena);
+        scan(source, &symbols, &tokens);
+        work = scanned(source, tokens);
+        std::vector<char> buffer(work.instructions * 2 + 2);
+        Diagnostics diagnostics;
+        Compiler compiler(&tokens, source.data(), source.size(), &symbols,
+                          &arena, &diagnostics);
+
+        auto begin = std::chrono::steady_clock::now();
+        compiler.compile(buffer.data(), buffer.size());
+        double elapsed = seconds(begin);
+        best = elapsed < best ? elapsed : best;
+        if (compiler.hadError) {
+            diagnostics.print(stderr);
+            exit(1);
+        }
+    }
+    report(name, work, best);
+}
+
+int main(int argc, char *argv[]) {
+    CorpusOptions options = defaultCorpus();
+    if (argc > 1)
+        options.size = strtoull(argv[1], nullptr, 10);
+    int rounds = argc > 2 ? atoi(argv[2]) : 5;
+    if (argc > 3)
+        options.labels = atof(argv[3]);
+    if (argc > 4)
+        options.comments = atof(argv[4]);
+    if (argc > 5)
+        options.binary = atof(argv[5]);
+
+    std::string source = generateCorpus(options);
+    printf("{\"corpus\": {\"bytes\": %zu, \"labels\": %.2f, "
+           "\"comments\": %.2f, \"binary\": %.2f, \"seed\": %u}}\n",
+           source.size(), options.labels, options.comments, options.binary,
+           options.seed);
+
+    Arena arena;
+    SymbolTable symbols(&arena);
+    TokenList tokens(&arena);
+    scan(source, &symbols, &tokens);
+
+    benchScan(source, rounds);
+    benchMnemonics(source, tokens, rounds);
+    benchLiterals(source, tokens, rounds);
+    benchSymbols(source, tokens, rounds);
+    benchCompile("compile", source, rounds);
+
+    // mostly labels and the jumps between them, so most of the time goes
+    // into defining labels and patching forward references
+    CorpusOptions labelHeavy = options;
+    labelHeavy.labels = 0.5;
+    labelHeavy.comments = 0;
+    benchCompile("compile_labels", generateCorpus(labelHeavy), rounds);
+    return 0;
+}
@@ -0,0 +1,45 @@
+#!/usr/bin/env bash
+# Runs an instrumented ch8asm the ways it is used, so `make pgo` has a
+# profile to optimize for:
+#   bench/train.sh ch8asm corpus_gen workdir
+# The hand-written programs in bench/train and the test cases stand in for
+# real sources, the generated ones cover the sizes and mixes those lack.
+
+set -e
+exec=$1
+gen=$2
+work=$3
+mkdir -p "$work"
+
+for i in bench/train/*.asm test/asm/*.asm; do
+  "$exec" "$i" "$work/out.bin"
+  "$exec" -c "$i" "$work/out.o"
+done
+
+# programs of a few KiB as they come out of real projects, one at a time
+# and as a batch
+rm -f "$work/manifest.txt"
+for seed in $(seq 1 200); do
+  "$gen" -s $((1000 + seed * 40)) -l 0.1 -c 0.3 -b 0.25 -r $seed \
+    > "$work/gen$seed.asm"
+  echo "$work/gen$seed.asm $work/gen$seed.bin" >> "$work/manifest.txt"
+done
+for seed in $(seq 1 20); do
+  "$exec" "$work/gen$seed.asm" "$work/out.bin"
+done
+"$exec" -j 1 --batch "@$work/manifest.txt"
+"$exec" --batch "@$work/manifest.txt"
+
+# large sources that still fit a ROM, padded with constants and with labels
+# (see pad.awk) past the sizes at which the scanner splits the source and
+# the compiler emits in parallel, so four threads train those paths as well
+"$gen" -s 48000 -r 1 | awk -v lines=30 -f "$(dirname "$0")/pad.awk" \
+  > "$work/large.asm"
+"$gen" -s 24000 -l 0.5 -c 0 -r 2 |
+  awk -v lines=100 -v kind=labels -f "$(dirname "$0")/pad.awk" \
+  > "$work/labels.asm"
+for i in "$work/large.asm" "$work/labels.asm"; do
+  "$exec" -j 1 "$i" "$work/out.bin"
+  "$exec" -j 4 "$i" "$work/out.bin"
+  "$exec" --pipeline "$i" "$work/out.bin"
+done
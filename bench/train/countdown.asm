@@ -0,0 +1,60 @@
+; counts down from a number entered on the keypad, showing the remaining
+; seconds as three decimal digits
+.include "keys.inc"
+
+digitX = $1C
+digitY = $0C
+second = $3C
+
+start:
+    CLS
+    WKP V0          ; the number of seconds
+    LD V1, V0
+    SHL V1, V1
+    SHL V1, V1
+    ADD V1, V0      ; five times what was pressed
+    CALL showDigits
+
+tick:
+    LD V2, second
+    SDT V2
+waitSecond:
+    GDT V2
+    SE V2, $00
+    JP waitSecond
+
+    CALL showDigits ; erases them, drawing is XOR
+    SE V1, $00
+    JP next
+    JP done
+next:
+    ADD V1, $FF     ; minus one
+    CALL showDigits
+    LD V3, keyFire
+    SKNP V3
+    JP start        ; start over while fire is held
+    JP tick
+
+done:
+    LD V2, $20
+    SST V2
+    CALL showDigits
+halt:
+    JP halt
+
+; draws V1 as three digits, the hundreds stored at I by BCD
+showDigits:
+    LD I, $300
+    BCD V1
+    LDV V2
+    LD V3, digitX
+    LD V4, digitY
+    FNT V0
+    DRW V3, V4, $5
+    ADD V3, $05
+    FNT V1
+    DRW V3, V4, $5
+    ADD V3, $05
+    FNT V2
+    DRW V3, V4, $5
+    RET
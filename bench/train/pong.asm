@@ -0,0 +1,136 @@
+; one player pong against the right wall
+.include "keys.inc"
+
+paddleX = $02
+paddleTop = $0C
+ballStart = $20
+maxY = $1F
+maxX = $3F
+
+init:
+    CLS
+    LD V0, paddleX
+    LD V1, paddleTop
+    LD V2, ballStart   ; ball x
+    LD V3, $10         ; ball y
+    LD V4, $01         ; ball dx, $FF to the left
+    LD V5, $01         ; ball dy
+    LD V6, $00         ; score
+    CALL drawPaddle
+    CALL drawBall
+    CALL drawScore
+
+loop:
+    LD V7, $02
+    SDT V7
+    CALL movePaddle
+    CALL moveBall
+    SE VF, $00
+    JP missed
+frame:
+    GDT V7
+    SE V7, $00
+    JP frame
+    JP loop
+
+missed:
+    LD V7, $10
+    SST V7
+    CALL drawBall
+    LD V2, ballStart
+    RND V3, $1F
+    LD V4, $01
+    CALL drawBall
+    JP loop
+
+movePaddle:
+    LD V7, keyUp
+    SKNP V7
+    JP paddleUp
+    LD V7, keyDown
+    SKNP V7
+    JP paddleDown
+    RET
+paddleUp:
+    SNE V1, $00
+    RET
+    CALL drawPaddle
+    ADD V1, $FF
+    JP drawPaddle
+paddleDown:
+    SNE V1, $1A
+    RET
+    CALL drawPaddle
+    ADD V1, $01
+    JP drawPaddle
+
+; sets VF when the ball passed the paddle
+moveBall:
+    CALL drawBall
+    ADD V2, V4
+    ADD V3, V5
+    SNE V3, $00
+    LD V5, $01
+    SNE V3, maxY
+    LD V5, $FF
+    SNE V2, maxX
+    LD V4, $FF
+    SE V2, $03
+    JP ballDrawn
+    ; at the paddle, is it in front of it
+    LD V8, V3
+    SUB V8, V1
+    SE VF, $01
+    JP miss
+    LD V9, $06
+    SUBN V9, V8
+    SE VF, $00
+    JP miss
+    LD V4, $01
+    CALL drawScore
+    ADD V6, $01
+    CALL drawScore
+ballDrawn:
+    CALL drawBall
+    LD VF, $00
+    RET
+miss:
+    CALL drawBall
+    LD VF, $01
+    RET
+
+drawPaddle:
+    LD I, $300
+    LD V7, %11000000
+    STV V7
+    LD V7, $00
+    LD V8, V1
+    DRW V0, V8, $1
+    ADD V8, $01
+    DRW V0, V8, $1
+    ADD V8, $01
+    DRW V0, V8, $1
+    ADD V8, $01
+    DRW V0, V8, $1
+    ADD V8, $01
+    DRW V0, V8, $1
+    ADD V8, $01
+    DRW V0, V8, $1
+    RET
+
+drawBall:
+    LD I, $301
+    LD V7, %10000000
+    STV V7
+    DRW V2, V3, $1
+    RET
+
+drawScore:
+    LD I, $302
+    BCD V6
+    LDV V2
+    LD V9, $36
+    LD VA, $01
+    FNT V2
+    DRW V9, VA, $5
+    RET
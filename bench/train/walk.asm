@@ -0,0 +1,62 @@
+; draws random hex digits along a random walk until a key is pressed,
+; clearing the screen whenever the walk runs into its own trail
+.include "keys.inc"
+
+stepX = $05
+stepY = $06
+width = $3B
+height = $1A
+
+start:
+    CLS
+    LD V0, $1E
+    LD V1, $0D
+
+step:
+    RND V2, $0F
+    FNT V2
+    DRW V0, V1, $5
+    SE VF, $00
+    JP start
+    RND V3, %00000011
+    SNE V3, $00
+    JP right
+    SNE V3, $01
+    JP left
+    SNE V3, $02
+    JP down
+up:
+    SE V1, $00
+    ADD V1, $FA
+    JP pause
+down:
+    SNE V1, height
+    JP pause
+    ADD V1, stepY
+    JP pause
+left:
+    SE V0, $00
+    ADD V0, $FB
+    JP pause
+right:
+    SNE V0, width
+    JP pause
+    ADD V0, stepX
+
+pause:
+    LD V4, $04
+    SDT V4
+wait:
+    LD V5, keyFire
+    SKP V5
+    JP still
+    JP stop
+still:
+    GDT V4
+    SE V4, $00
+    JP wait
+    JP step
+
+stop:
+    WKP V5
+    JP start
@@ -0,0 +1,59 @@
+// libFuzzer entry point for the scanner and compiler (`make fuzz`). Every
+// input is assembled in memory twice, into a ROM and into an object that
+// has to survive encoding and decoding, and nothing touches a file:
+// .include is reported like any other unsupported directive. The arena is
+// kept between inputs like a long running Assembler keeps it.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "../src/arena.h"
+#include "../src/assembler.h"
+#include "../src/compiler.h"
+#include "../src/diagnostics.h"
+#include "../src/object.h"
+#include "../src/scanner.h"
+#include "../src/symbols.h"
+#include "../src/token.h"
+
+static void assemble(const char *source, size_t length, Arena *arena,
+                     bool relocatable) {
+    arena->reset();
+    SymbolTable symbols(arena);
+    TokenList tokens(arena);
+    Diagnostics diagnostics;
+    Scanner scanner(source, length, &symbols, &diagnostics);
+    scanner.scan(&tokens);
+    if (scanner.hadError)
+        return;
+
+    char rom[MAX_ROM_LENGTH];
+    Compiler compiler(&tokens, source, length, &symbols, arena,
+                      &diagnostics);
+    compiler.relocatable = relocatable;
+    int written = compiler.compile(rom, sizeof(rom));
+    if (written < 0 || written > (int)sizeof(rom))
+        abort();
+    if (!relocatable || compiler.hadError)
+        return;
+
+    ObjectFile object, decoded;
+    std::vector<char> bytes;
+    compiler.fillObject(&object);
+    object.files[0] = "fuzz";
+    encodeObject(object, &bytes);
+    if (!decodeObject(bytes.data(), bytes.size(), &decoded) ||
+        decoded.code != object.code)
+        abort();
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static Arena arena;
+    if (size > MAX_SOURCE_LENGTH)
+        return 0;
+    assemble((const char *)data, size, &arena, false);
+    assemble((const char *)data, size, &arena, true);
+    return 0;
+}
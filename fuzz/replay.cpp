@@ -0,0 +1,52 @@
+// Runs the fuzz target once on each file given, and on every file in each
+// directory given, for compilers without libFuzzer and for replaying a
+// corpus or a crash:
+//   assemble_replay.x [files or directories...]
+
+#include <dirent.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <sys/stat.h>
+
+#include "../src/io.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static bool replay(const std::string &path) {
+    SourceFile file;
+    if (!openSource(path.c_str(), &file)) {
+        fprintf(stderr, "Could not read file \"%s\".\n", path.c_str());
+        return false;
+    }
+    LLVMFuzzerTestOneInput((const uint8_t *)file.data, file.length);
+    closeSource(&file);
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    int inputs = 0;
+    bool ok = true;
+    for (int arg = 1; arg < argc; arg++) {
+        struct stat st;
+        DIR *dir;
+        if (stat(argv[arg], &st) != 0 || !S_ISDIR(st.st_mode) ||
+            (dir = opendir(argv[arg])) == nullptr) {
+            ok = replay(argv[arg]) && ok;
+            inputs++;
+            continue;
+        }
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            std::string path = std::string(argv[arg]) + "/" + entry->d_name;
+            if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+                ok = replay(path) && ok;
+                inputs++;
+            }
+        }
+        closedir(dir);
+    }
+    printf("%d inputs\n", inputs);
+    return ok ? 0 : 74;
+}
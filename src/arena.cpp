@@ -0,0 +1,82 @@
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "arena.h"
+
+Arena::Arena(size_t blockSize) {
+    this->blockSize = blockSize;
+    this->first = nullptr;
+    this->current = nullptr;
+    this->usedBytes = 0;
+    this->peakBytes = 0;
+    this->reservedBytes = 0;
+}
+
+Arena::~Arena() {
+    Block *block = first;
+    while (block != nullptr) {
+        Block *next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
+Arena::Block *Arena::newBlock(size_t minimum) {
+    size_t size = minimum > blockSize ? minimum : blockSize;
+    Block *block = (Block *)malloc(sizeof(Block) + size);
+    if (block == nullptr)
+        throw std::bad_alloc();
+    block->next = nullptr;
+    block->size = size;
+    block->used = 0;
+    reservedBytes += size;
+    return block;
+}
+
+void *Arena::allocate(size_t size, size_t align) {
+    // try the current block, then any block kept from before the last reset,
+    // and only then go to the heap
+    while (current != nullptr) {
+        uintptr_t base = (uintptr_t)data(current);
+        uintptr_t start = (base + current->used + align - 1) & ~(align - 1);
+        if (start + size <= base + current->size) {
+            usedBytes += start + size - (base + current->used);
+            current->used = start + size - base;
+            if (usedBytes > peakBytes)
+                peakBytes = usedBytes;
+            return (void *)start;
+        }
+        if (current->next == nullptr)
+            break;
+        current = current->next;
+    }
+
+    Block *block = newBlock(size + align);
+    if (current == nullptr) {
+        first = block;
+    } else {
+        current->next = block;
+    }
+    current = block;
+    return allocate(size, align);
+}
+
+void Arena::release(void *pointer, size_t size) {
+    if (current == nullptr)
+        return;
+    char *end = data(current) + current->used;
+    if ((char *)pointer + size == end) {
+        current->used -= size;
+        usedBytes -= size;
+    }
+}
+
+void Arena::reset() {
+    for (Block *block = first; block != nullptr; block = block->next) {
+        block->used = 0;
+    }
+    current = first;
+    usedBytes = 0;
+    peakBytes = 0;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stddef.h>
+
+// Bump allocator that owns every allocation of one assembly. Memory is only
+// given back in one go by reset(), which keeps the blocks around so the next
+// assembly does not touch the heap at all once the arena is warm.
+//
+// Anything allocated from the arena must be destroyed before reset().
+class Arena {
+  public:
+    Arena(size_t blockSize = 64 * 1024);
+    ~Arena();
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t size, size_t align);
+    // only the most recent allocation can actually be given back, anything
+    // else stays allocated until reset(). That does not cover a growing
+    // vector: its old buffer is freed after the new one is allocated above
+    // it, so every outgrown buffer stays. Containers that may get large are
+    // reserved up front for that reason.
+    void release(void *pointer, size_t size);
+    void reset();
+
+    size_t used() { return usedBytes; }
+    size_t peak() { return peakBytes; } // since the last reset()
+    size_t reserved() { return reservedBytes; }
+
+  private:
+    typedef struct Block {
+        struct Block *next;
+        size_t size;
+        size_t used;
+    } Block;
+
+    Block *first;
+    Block *current;
+    size_t blockSize;
+    size_t usedBytes;
+    size_t peakBytes;
+    size_t reservedBytes;
+
+    Block *newBlock(size_t minimum);
+    char *data(Block *block) { return (char *)(block + 1); }
+};
+
+// Lets standard containers allocate from an Arena.
+template <typename T> class ArenaAllocator {
+  public:
+    typedef T value_type;
+
+    Arena *arena;
+
+    ArenaAllocator(Arena *arena) : arena(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(size_t n) {
+        return (T *)arena->allocate(n * sizeof(T), alignof(T));
+    }
+    void deallocate(T *pointer, size_t n) {
+        arena->release(pointer, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const {
+        return arena == other.arena;
+    }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const {
+        return arena != other.arena;
+    }
+};
@@ -0,0 +1,194 @@
+#include <string.h>
+
+#include "assembler.h"
+#include "bytes.h"
+#include "compiler.h"
+#include "include.h"
+#include "object.h"
+#include "parallelscan.h"
+#include "pipeline.h"
+#include "stats.h"
+#include "symbols.h"
+#include "token.h"
+
+Output::Output() : storage(MAX_ROM_LENGTH) {
+    this->data = storage.data();
+    this->capacity = storage.size();
+    this->length = 0;
+}
+
+Output::Output(char *buffer, size_t capacity) {
+    this->data = buffer;
+    this->capacity = capacity;
+    this->length = 0;
+}
+
+Assembler::Assembler(int threads) {
+    this->threads = threads;
+    this->pipeline = false;
+    this->scanBackend = detectScanBackend();
+    this->includes = &ownIncludes;
+    this->stats = nullptr;
+}
+
+AssembleStatus Assembler::assemble(const char *source, size_t length,
+                                   Output *output, Diagnostics *diagnostics) {
+    output->length = 0;
+    if (length > MAX_SOURCE_LENGTH) {
+        return ASSEMBLE_SOURCE_TOO_LARGE;
+    }
+    int capacity = output->capacity < MAX_ROM_LENGTH ? output->capacity
+                                                     : MAX_ROM_LENGTH;
+    int written = 0;
+    AssembleStatus status = build(source, length, output->data, capacity,
+                                  &written, nullptr, diagnostics);
+    if (status == ASSEMBLE_OK) {
+        output->length = written;
+    }
+    return status;
+}
+
+AssembleStatus Assembler::assembleObject(const char *source, size_t length,
+                                         ObjectFile *object,
+                                         Diagnostics *diagnostics) {
+    object->clear();
+    if (length > MAX_SOURCE_LENGTH) {
+        return ASSEMBLE_SOURCE_TOO_LARGE;
+    }
+    char code[MAX_ROM_LENGTH];
+    int written = 0;
+    return build(source, length, code, sizeof(code), &written, object,
+                 diagnostics);
+}
+
+static void collectStats(Stats *stats, SymbolTable *symbols, Arena *arena) {
+    if (stats == nullptr)
+        return;
+    stats->symbols = symbols->count();
+    stats->symbolLookups = symbols->lookups();
+    stats->symbolProbes = symbols->probes();
+    stats->arenaPeak = arena->peak();
+    stats->arenaReserved = arena->reserved();
+}
+
+// fills object instead of resolving every label when it is not nullptr
+AssembleStatus Assembler::build(const char *source, size_t length,
+                                char *buffer, int capacity, int *written,
+                                ObjectFile *object,
+                                Diagnostics *diagnostics) {
+    AssembleStatus status = ASSEMBLE_OK;
+    dependencies.clear();
+    arena.reset();
+    // everything allocated from the arena is gone before the next reset()
+    SymbolTable symbols(&arena);
+    // the pipeline compiles tokens as they come, before includes could be
+    // spliced in
+    if (pipeline && object == nullptr &&
+        memmem(source, length, ".include", 8) == nullptr) {
+        // scanning and compiling overlap, all of it counts as compiling
+        PipelineStatus result;
+        {
+            PhaseTimer timer(stats, PHASE_COMPILE);
+            result = assemblePipelined(source, length, &symbols, &arena,
+                                       diagnostics, buffer, capacity,
+                                       written, scanKernels(scanBackend));
+        }
+        collectStats(stats, &symbols, &arena);
+        if (result == PIPELINE_SCAN_ERROR) {
+            status = ASSEMBLE_SCAN_ERROR;
+        } else if (result == PIPELINE_COMPILE_ERROR) {
+            status = ASSEMBLE_COMPILE_ERROR;
+        }
+        return status;
+    }
+
+    TokenList tokens(&arena);
+    ExpandedSource expanded(&arena);
+    bool scanned;
+    {
+        PhaseTimer timer(stats, PHASE_SCAN);
+        scanned = scanSource(source, length, &symbols, &tokens, diagnostics,
+                             threads, scanKernels(scanBackend));
+    }
+    if (!scanned) {
+        collectStats(stats, &symbols, &arena);
+        return ASSEMBLE_SCAN_ERROR;
+    } else if (hasIncludes(source, tokens)) {
+        PhaseTimer timer(stats, PHASE_INCLUDE);
+        bool ok = expandIncludes(path.c_str(), source, length, tokens,
+                                 includes, &expanded, diagnostics);
+        dependencies = expanded.dependencies;
+        if (!ok) {
+            collectStats(stats, &symbols, &arena);
+            return ASSEMBLE_SCAN_ERROR;
+        }
+    }
+
+    bool spliced = !expanded.files.empty();
+    if (stats != nullptr)
+        stats->countTokens(spliced ? expanded.tokens : tokens);
+    Compiler compiler(spliced ? &expanded.tokens : &tokens,
+                      spliced ? expanded.text.data() : source,
+                      spliced ? expanded.text.size() : length, &symbols,
+                      &arena, diagnostics);
+    if (spliced)
+        compiler.sourceMap = &expanded.map;
+    compiler.relocatable = object != nullptr;
+    compiler.stats = stats;
+    {
+        PhaseTimer timer(stats, PHASE_COMPILE);
+        *written = compiler.compile(buffer, capacity, threads);
+    }
+    collectStats(stats, &symbols, &arena);
+    if (compiler.hadError) {
+        status = ASSEMBLE_COMPILE_ERROR;
+    } else if (object != nullptr) {
+        compiler.fillObject(object);
+        object->files[0] = path;
+    }
+    return status;
+}
+
+void encodeResult(AssembleStatus status, const Output &output,
+                  const Diagnostics &diagnostics, std::vector<char> *bytes) {
+    putU32(bytes, status);
+    putU32(bytes, output.length);
+    bytes->insert(bytes->end(), output.data, output.data + output.length);
+    putU32(bytes, diagnostics.list.size());
+    for (const Diagnostic &diagnostic : diagnostics.list) {
+        putU32(bytes, diagnostic.line);
+        putString(bytes, diagnostic.file);
+        putString(bytes, diagnostic.message);
+    }
+}
+
+bool decodeResult(const char *bytes, size_t length, AssembleStatus *status,
+                  Output *output, Diagnostics *diagnostics) {
+    Reader reader = {(const uint8_t *)bytes, (const uint8_t *)bytes + length};
+    uint32_t value, romLength, count;
+    if (!getU32(&reader, &value) || !getU32(&reader, &romLength) ||
+        romLength > output->capacity ||
+        !getBytes(&reader, output->data, romLength) ||
+        !getU32(&reader, &count))
+        return false;
+    *status = (AssembleStatus)value;
+    output->length = romLength;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t line;
+        Diagnostic diagnostic;
+        if (!getU32(&reader, &line) ||
+            !getString(&reader, &diagnostic.file) ||
+            !getString(&reader, &diagnostic.message))
+            return false;
+        diagnostic.line = line;
+        diagnostics->list.push_back(diagnostic);
+    }
+    return true;
+}
+
+AssembleStatus assemble(const char *source, size_t length, Output *output,
+                        Diagnostics *diagnostics) {
+    Assembler assembler;
+    return assembler.assemble(source, length, output, diagnostics);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "arena.h"
+#include "diagnostics.h"
+#include "fastscan.h"
+#include "include.h"
+#include "object.h"
+#include "stats.h"
+
+// programs are loaded at 0x200, everything above that is theirs
+#define MAX_ROM_LENGTH (4096 - 512)
+
+typedef enum {
+    ASSEMBLE_OK,
+    ASSEMBLE_SOURCE_TOO_LARGE,
+    ASSEMBLE_SCAN_ERROR,
+    ASSEMBLE_COMPILE_ERROR,
+} AssembleStatus;
+
+// Receives the ROM. By default it owns a buffer that fits any program, or it
+// writes into the caller's buffer, in which case a program that does not fit
+// is reported like any other error.
+class Output {
+  public:
+    Output();
+    Output(char *buffer, size_t capacity);
+    Output(const Output &) = delete;
+    Output &operator=(const Output &) = delete;
+
+    char *data;
+    size_t capacity;
+    size_t length;
+
+  private:
+    std::vector<char> storage;
+};
+
+// Assembles sources in memory without stdio or any global state, so any
+// number of assemblers can run at once on different threads. The only files
+// it touches are those named by .include, which are read from disk through
+// its IncludeCache. The arena is kept between calls, which makes assembling
+// many small programs with one Assembler almost free of heap traffic.
+class Assembler {
+  public:
+    Assembler(int threads = 1);
+
+    AssembleStatus assemble(const char *source, size_t length,
+                            Output *output, Diagnostics *diagnostics);
+    // a module for ch8link, labels it does not define are left to the
+    // linker (see object.h)
+    AssembleStatus assembleObject(const char *source, size_t length,
+                                  ObjectFile *object,
+                                  Diagnostics *diagnostics);
+
+    int threads;
+    bool pipeline; // see pipeline.h
+    // SIMD kernels of the scanner, the best the CPU supports by default
+    ScanBackend scanBackend;
+    Arena arena;
+    // where the source came from, .include is relative to its directory
+    std::string path;
+    // shared by all assemblers that should scan each included file once,
+    // by default every Assembler has its own
+    IncludeCache *includes;
+    std::vector<Dependency> dependencies; // of the last source
+    // filled in by every assembly when set, see --stats
+    Stats *stats;
+
+  private:
+    IncludeCache ownIncludes;
+
+    AssembleStatus build(const char *source, size_t length, char *buffer,
+                         int capacity, int *written, ObjectFile *object,
+                         Diagnostics *diagnostics);
+};
+
+// A finished assembly as bytes, for the server and the cache: status, ROM
+// length, ROM, diagnostic count, then per diagnostic its line, file name
+// length and name, message length and message, with all integers 32 bit
+// little endian.
+void encodeResult(AssembleStatus status, const Output &output,
+                  const Diagnostics &diagnostics, std::vector<char> *bytes);
+// false when the bytes are cut short or the ROM does not fit the output
+bool decodeResult(const char *bytes, size_t length, AssembleStatus *status,
+                  Output *output, Diagnostics *diagnostics);
+
+// one-off assembly with a fresh single threaded Assembler
+AssembleStatus assemble(const char *source, size_t length, Output *output,
+                        Diagnostics *diagnostics);
@@ -0,0 +1,222 @@
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+
+#include "assembler.h"
+#include "batch.h"
+#include "io.h"
+#include "object.h"
+
+typedef enum {
+    BATCH_OK,
+    BATCH_READ_ERROR,
+    BATCH_WRITE_ERROR,
+    BATCH_DEPFILE_ERROR,
+    BATCH_ASSEMBLE_ERROR,
+} BatchResult;
+
+typedef struct {
+    BatchResult result;
+    AssembleStatus status;
+    Diagnostics diagnostics;
+    size_t arenaPeak; // both 0 when the cache had the file
+    size_t arenaReserved;
+} BatchOutcome;
+
+BatchJob batchJob(const char *input, const char *extension) {
+    BatchJob job;
+    job.input = input;
+    job.output = input;
+    size_t length = job.output.size();
+    if (length > 4 && job.output.compare(length - 4, 4, ".asm") == 0) {
+        job.output.resize(length - 4);
+    }
+    job.output += extension;
+    return job;
+}
+
+bool readManifest(const char *path, std::vector<BatchJob> *jobs,
+                  const char *extension) {
+    FILE *file = fopen(path, "r");
+    if (file == nullptr)
+        return false;
+
+    char line[4096];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        char *input = strtok(line, " \t\r\n");
+        if (input == nullptr || input[0] == ';')
+            continue;
+        BatchJob job = batchJob(input, extension);
+        char *output = strtok(nullptr, " \t\r\n");
+        if (output != nullptr)
+            job.output = output;
+        jobs->push_back(job);
+    }
+
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+// everything a worker keeps between files, so a warm worker assembles the
+// next one into the buffers left from the last
+typedef struct {
+    Assembler assembler;
+    Output output;
+    ObjectFile module;
+    std::vector<char> object;
+    std::vector<Dependency> dependencies;
+} BatchWorker;
+
+static void assembleJob(BatchWorker *w, AssemblyCache *cache,
+                        const BatchOptions &options, const BatchJob &job,
+                        BatchOutcome *outcome) {
+    SourceFile source;
+    if (!openSource(job.input.c_str(), &source)) {
+        outcome->result = BATCH_READ_ERROR;
+        return;
+    }
+
+    Assembler *assembler = &w->assembler;
+    w->object.clear();
+    w->dependencies.clear();
+    const char *input = job.input.c_str();
+    bool assembled = true;
+    if (options.objects) {
+        assembler->path = job.input;
+        outcome->status = assembler->assembleObject(
+            source.data, source.length, &w->module, &outcome->diagnostics);
+        w->dependencies = assembler->dependencies;
+        encodeObject(w->module, &w->object);
+    } else if (cache == nullptr ||
+               !cache->lookup(input, source.data, source.length,
+                              &outcome->status, &w->output,
+                              &outcome->diagnostics, &w->dependencies)) {
+        assembler->path = job.input;
+        outcome->status = assembler->assemble(
+            source.data, source.length, &w->output, &outcome->diagnostics);
+        w->dependencies = assembler->dependencies;
+        if (cache != nullptr)
+            cache->store(input, source.data, source.length, outcome->status,
+                         w->output, outcome->diagnostics, w->dependencies);
+    } else {
+        assembled = false;
+    }
+    if (assembled) {
+        outcome->arenaPeak = assembler->arena.peak();
+        outcome->arenaReserved = assembler->arena.reserved();
+    }
+    const char *data = options.objects ? w->object.data() : w->output.data;
+    size_t length = options.objects ? w->object.size() : w->output.length;
+    if (outcome->status != ASSEMBLE_OK) {
+        outcome->result = BATCH_ASSEMBLE_ERROR;
+    } else if (!writeRom(job.output.c_str(), data, length)) {
+        outcome->result = BATCH_WRITE_ERROR;
+    } else if (options.depfiles &&
+               !writeDepfile((job.output + ".d").c_str(), job.output.c_str(),
+                             input, w->dependencies)) {
+        outcome->result = BATCH_DEPFILE_ERROR;
+    } else {
+        outcome->result = BATCH_OK;
+    }
+    closeSource(&source);
+}
+
+// Workers take the next job off a shared counter until none are left, so
+// a few large files can not hold up a worker while others sit idle.
+static void worker(const std::vector<BatchJob> *jobs,
+                   std::vector<BatchOutcome> *outcomes,
+                   std::atomic<size_t> *next, AssemblyCache *cache,
+                   IncludeCache *includes, const BatchOptions *options) {
+    BatchWorker w;
+    w.assembler.includes = includes;
+    w.assembler.pipeline = options->pipeline;
+    size_t i;
+    while ((i = next->fetch_add(1, std::memory_order_relaxed)) <
+           jobs->size()) {
+        assembleJob(&w, cache, *options, (*jobs)[i], &(*outcomes)[i]);
+    }
+}
+
+int runBatch(const std::vector<BatchJob> &jobs, int threads,
+             AssemblyCache *cache, const BatchOptions &options) {
+    auto begin = std::chrono::steady_clock::now();
+
+    std::vector<BatchOutcome> outcomes(jobs.size());
+    std::atomic<size_t> next(0);
+    if ((size_t)threads > jobs.size())
+        threads = jobs.size();
+    if (threads < 1)
+        threads = 1;
+
+    IncludeCache includes;
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) {
+        pool.emplace_back(worker, &jobs, &outcomes, &next, cache, &includes,
+                          &options);
+    }
+    worker(&jobs, &outcomes, &next, cache, &includes, &options);
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - begin)
+                         .count();
+
+    int exitCode = 0;
+    int failed = 0;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        const BatchJob &job = jobs[i];
+        BatchOutcome &outcome = outcomes[i];
+        switch (outcome.result) {
+            case BATCH_OK: {
+                if (options.verbose && outcome.arenaReserved > 0)
+                    fprintf(options.log,
+                            "%s: peak arena usage %zu bytes (%zu reserved)\n",
+                            job.input.c_str(), outcome.arenaPeak,
+                            outcome.arenaReserved);
+            } break;
+            case BATCH_READ_ERROR: {
+                fprintf(options.log, "Could not read file \"%s\".\n",
+                        job.input.c_str());
+                exitCode = 74;
+            } break;
+            case BATCH_WRITE_ERROR: {
+                fprintf(options.log, "Could not write file \"%s\".\n",
+                        job.output.c_str());
+                exitCode = 74;
+            } break;
+            case BATCH_DEPFILE_ERROR: {
+                fprintf(options.log, "Could not write file \"%s.d\".\n",
+                        job.output.c_str());
+                exitCode = 74;
+            } break;
+            case BATCH_ASSEMBLE_ERROR: {
+                fprintf(options.log, "%s:\n", job.input.c_str());
+                if (outcome.status == ASSEMBLE_SOURCE_TOO_LARGE) {
+                    fprintf(options.log, "File \"%s\" is too large.\n",
+                            job.input.c_str());
+                } else {
+                    outcome.diagnostics.print(options.log);
+                    fprintf(options.log,
+                            outcome.status == ASSEMBLE_SCAN_ERROR
+                                ? "Scanning failed.\n"
+                                : "Compiling failed.\n");
+                }
+                if (exitCode == 0)
+                    exitCode = 65;
+            } break;
+        }
+        if (outcome.result != BATCH_OK)
+            failed++;
+    }
+
+    fprintf(options.log,
+            "%zu files (%d failed) in %.3f s on %d threads, %.0f files/s\n",
+            jobs.size(), failed, seconds, threads,
+            seconds > 0 ? jobs.size() / seconds : 0.0);
+    return exitCode;
+}
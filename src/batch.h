@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "cache.h"
+
+typedef struct {
+    std::string input;
+    std::string output;
+} BatchJob;
+
+typedef struct {
+    bool depfiles; // make rules for each output in "output.d"
+    bool objects;  // objects for ch8link instead of ROMs, never cached
+    bool pipeline; // see pipeline.h
+    bool verbose;  // the peak arena usage of each file
+    FILE *log;     // gets the diagnostics and the summary
+} BatchOptions;
+
+// the output goes next to the source, "name.asm" becomes "name.bin" (or
+// whatever extension says)
+BatchJob batchJob(const char *input, const char *extension = ".bin");
+
+// A manifest lists one "input [output]" pair per line, lines starting with
+// ';' are comments. Returns false when it can not be read.
+bool readManifest(const char *path, std::vector<BatchJob> *jobs,
+                  const char *extension = ".bin");
+
+// Assembles every job on up to threads workers, each with its own Assembler
+// that is reused for all the files it takes, going through cache unless it
+// is nullptr. Diagnostics are printed to the log per file in job order once
+// all are done, followed by the overall files/s. Returns the exit code for
+// the whole batch. Included files are scanned once for the whole batch.
+int runBatch(const std::vector<BatchJob> &jobs, int threads,
+             AssemblyCache *cache, const BatchOptions &options);
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Little endian integers and length prefixed strings for the formats that
+// leave the process (see encodeResult() and object.h).
+
+inline void putU32(std::vector<char> *bytes, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        bytes->push_back((char)(value >> (i * 8)));
+    }
+}
+
+inline void putU64(std::vector<char> *bytes, uint64_t value) {
+    putU32(bytes, (uint32_t)value);
+    putU32(bytes, (uint32_t)(value >> 32));
+}
+
+inline void putString(std::vector<char> *bytes, const std::string &text) {
+    putU32(bytes, text.size());
+    bytes->insert(bytes->end(), text.begin(), text.end());
+}
+
+// a cursor over the encoded bytes that fails once they run out
+typedef struct {
+    const uint8_t *at;
+    const uint8_t *end;
+} Reader;
+
+inline bool getU32(Reader *reader, uint32_t *value) {
+    if (reader->end - reader->at < 4)
+        return false;
+    const uint8_t *p = reader->at;
+    *value = p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+    reader->at += 4;
+    return true;
+}
+
+inline bool getU64(Reader *reader, uint64_t *value) {
+    uint32_t low, high;
+    if (!getU32(reader, &low) || !getU32(reader, &high))
+        return false;
+    *value = low | (uint64_t)high << 32;
+    return true;
+}
+
+inline bool getBytes(Reader *reader, void *data, uint32_t length) {
+    if ((size_t)(reader->end - reader->at) < length)
+        return false;
+    if (length > 0) // data may be the nullptr of an empty vector
+        memcpy(data, reader->at, length);
+    reader->at += length;
+    return true;
+}
+
+inline bool getString(Reader *reader, std::string *text) {
+    uint32_t length;
+    if (!getU32(reader, &length) ||
+        (size_t)(reader->end - reader->at) < length)
+        return false;
+    text->assign((const char *)reader->at, length);
+    reader->at += length;
+    return true;
+}
@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "cache.h"
+#include "hash.h"
+
+#define ENTRY_MAGIC "CH8C"
+#define ENTRY_SUFFIX ".c8c"
+#define STATS_FILE "stats"
+
+// the same includes may name other files from another path or directory
+static uint64_t keyOf(const char *path, const char *source, size_t length) {
+    uint64_t seed = xxh64(CACHE_VERSION, strlen(CACHE_VERSION), 0);
+    if (memmem(source, length, ".include", 8) != nullptr) {
+        char cwd[4096];
+        if (getcwd(cwd, sizeof(cwd)) != nullptr)
+            seed = xxh64(cwd, strlen(cwd), seed);
+        seed = xxh64(path, strlen(path), seed);
+    }
+    return xxh64(source, length, seed);
+}
+
+static bool readFile(const char *path, std::vector<char> *data) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0;
+    if (ok) {
+        data->resize(st.st_size);
+        ok = read(fd, data->data(), st.st_size) == st.st_size;
+    }
+    close(fd);
+    return ok;
+}
+
+AssemblyCache::AssemblyCache(const char *directory, uint64_t maxBytes)
+    : directory(directory), maxBytes(maxBytes), hits(0), misses(0),
+      addedBytes(0), temporaries(0) {
+    mkdir(directory, 0755);
+}
+
+std::string AssemblyCache::entryPath(uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx" ENTRY_SUFFIX,
+             (unsigned long long)key);
+    return directory + name;
+}
+
+// An entry is the magic, the source length, the included files and then the
+// encodeResult() of its assembly. The length guards a little more against
+// hash collisions. Each included file is its path length, path and 64 bit
+// hash, after their 32 bit count.
+static bool readDependencies(const char **at, const char *end,
+                             std::vector<Dependency> *dependencies) {
+    uint32_t count, length;
+    if (end - *at < 4)
+        return false;
+    memcpy(&count, *at, 4);
+    *at += 4;
+    for (uint32_t i = 0; i < count; i++) {
+        Dependency dependency;
+        if (end - *at < 4)
+            return false;
+        memcpy(&length, *at, 4);
+        *at += 4;
+        if ((size_t)(end - *at) < length + sizeof(dependency.hash))
+            return false;
+        dependency.path.assign(*at, length);
+        memcpy(&dependency.hash, *at + length, sizeof(dependency.hash));
+        *at += length + sizeof(dependency.hash);
+        dependencies->push_back(dependency);
+    }
+    return true;
+}
+
+static bool unchanged(const std::vector<Dependency> &dependencies) {
+    std::vector<char> data;
+    for (const Dependency &dependency : dependencies) {
+        if (dependency.hash == UNREADABLE_HASH ||
+            !readFile(dependency.path.c_str(), &data) ||
+            xxh64(data.data(), data.size(), 0) != dependency.hash)
+            return false;
+    }
+    return true;
+}
+
+bool AssemblyCache::lookup(const char *path, const char *source,
+                           size_t length, AssembleStatus *status,
+                           Output *output, Diagnostics *diagnostics,
+                           std::vector<Dependency> *dependencies) {
+    std::string entryFile = entryPath(keyOf(path, source, length));
+    std::vector<char> entry;
+    uint32_t sourceLength;
+    size_t header = 4 + sizeof(sourceLength);
+    Diagnostics cached;
+    std::vector<Dependency> included;
+    bool hit = readFile(entryFile.c_str(), &entry) &&
+               entry.size() >= header &&
+               memcmp(entry.data(), ENTRY_MAGIC, 4) == 0;
+    if (hit) {
+        memcpy(&sourceLength, entry.data() + 4, sizeof(sourceLength));
+        const char *at = entry.data() + header;
+        const char *end = entry.data() + entry.size();
+        hit = sourceLength == length &&
+              readDependencies(&at, end, &included) && unchanged(included) &&
+              decodeResult(at, end - at, status, output, &cached);
+    }
+    if (!hit) {
+        misses++;
+        return false;
+    }
+
+    // the modification time doubles as the last use for eviction
+    utimensat(AT_FDCWD, entryFile.c_str(), nullptr, 0);
+    diagnostics->append(cached);
+    *dependencies = included;
+    hits++;
+    return true;
+}
+
+void AssemblyCache::store(const char *path, const char *source,
+                          size_t length, AssembleStatus status,
+                          const Output &output,
+                          const Diagnostics &diagnostics,
+                          const std::vector<Dependency> &dependencies) {
+    if (status == ASSEMBLE_SOURCE_TOO_LARGE)
+        return;
+    std::string entryFile = entryPath(keyOf(path, source, length));
+    // one with includes may be there but stale, so it is replaced
+    if (dependencies.empty() && access(entryFile.c_str(), F_OK) == 0)
+        return; // another process got there first
+
+    std::vector<char> entry(ENTRY_MAGIC, ENTRY_MAGIC + 4);
+    uint32_t sourceLength = length;
+    entry.insert(entry.end(), (char *)&sourceLength,
+                 (char *)&sourceLength + sizeof(sourceLength));
+    uint32_t count = dependencies.size();
+    entry.insert(entry.end(), (char *)&count, (char *)&count + 4);
+    for (const Dependency &dependency : dependencies) {
+        uint32_t pathLength = dependency.path.size();
+        entry.insert(entry.end(), (char *)&pathLength,
+                     (char *)&pathLength + 4);
+        entry.insert(entry.end(), dependency.path.begin(),
+                     dependency.path.end());
+        entry.insert(entry.end(), (char *)&dependency.hash,
+                     (char *)&dependency.hash + sizeof(dependency.hash));
+    }
+    encodeResult(status, output, diagnostics, &entry);
+
+    // readers only ever see complete entries
+    char name[64];
+    snprintf(name, sizeof(name), "/.tmp-%d-%llu", (int)getpid(),
+             (unsigned long long)temporaries++);
+    std::string temporary = directory + name;
+    int fd = open(temporary.c_str(),
+                  O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return;
+    bool ok = write(fd, entry.data(), entry.size()) == (ssize_t)entry.size();
+    ok = close(fd) == 0 && ok;
+    if (ok && rename(temporary.c_str(), entryFile.c_str()) == 0) {
+        addedBytes += entry.size();
+    } else {
+        unlink(temporary.c_str());
+    }
+}
+
+// drops the least recently used entries until a quarter of the cap is free,
+// returns the size of what is left
+uint64_t AssemblyCache::evict(uint64_t bytes) {
+    DIR *dir = opendir(directory.c_str());
+    if (dir == nullptr)
+        return bytes;
+
+    typedef struct {
+        std::string path;
+        struct timespec used;
+        uint64_t size;
+    } Entry;
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    struct dirent *dirent;
+    size_t suffixLength = strlen(ENTRY_SUFFIX);
+    while ((dirent = readdir(dir)) != nullptr) {
+        size_t nameLength = strlen(dirent->d_name);
+        if (nameLength <= suffixLength ||
+            strcmp(dirent->d_name + nameLength - suffixLength,
+                   ENTRY_SUFFIX) != 0)
+            continue;
+        std::string path = directory + "/" + dirent->d_name;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0)
+            continue;
+        entries.push_back({path, st.st_mtim, (uint64_t)st.st_size});
+        total += st.st_size;
+    }
+    closedir(dir);
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry &a, const Entry &b) {
+                  return a.used.tv_sec != b.used.tv_sec
+                             ? a.used.tv_sec < b.used.tv_sec
+                             : a.used.tv_nsec < b.used.tv_nsec;
+              });
+    uint64_t target = maxBytes / 4 * 3;
+    for (const Entry &entry : entries) {
+        if (total <= target)
+            break;
+        if (unlink(entry.path.c_str()) == 0)
+            total -= entry.size;
+    }
+    return total;
+}
+
+bool AssemblyCache::flush(CacheStats *totals) {
+    std::string path = directory + "/" STATS_FILE;
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+    while (flock(fd, LOCK_EX) != 0) {
+        if (errno != EINTR) {
+            close(fd);
+            return false;
+        }
+    }
+
+    char text[128];
+    ssize_t count = pread(fd, text, sizeof(text) - 1, 0);
+    text[count > 0 ? count : 0] = '\0';
+    CacheStats stats = {0, 0, 0};
+    unsigned long long h, m, b;
+    if (sscanf(text, "hits %llu misses %llu bytes %llu", &h, &m, &b) == 3) {
+        stats = {h, m, b};
+    }
+
+    stats.hits += hits.exchange(0);
+    stats.misses += misses.exchange(0);
+    stats.bytes += addedBytes.exchange(0);
+    if (stats.bytes > maxBytes) {
+        stats.bytes = evict(stats.bytes);
+    }
+
+    int length = snprintf(text, sizeof(text),
+                          "hits %llu misses %llu bytes %llu\n",
+                          (unsigned long long)stats.hits,
+                          (unsigned long long)stats.misses,
+                          (unsigned long long)stats.bytes);
+    bool ok = ftruncate(fd, 0) == 0 && pwrite(fd, text, length, 0) == length;
+    close(fd); // drops the lock
+    if (totals != nullptr)
+        *totals = stats;
+    return ok;
+}
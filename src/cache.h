@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include "assembler.h"
+#include "diagnostics.h"
+#include "include.h"
+
+// bumped whenever the same source could assemble differently
+#define CACHE_VERSION "ch8asm cache 2"
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t bytes; // size of all entries
+} CacheStats;
+
+// A directory of finished assemblies, ROM and diagnostics, keyed by the
+// XXH64 of the source and CACHE_VERSION, plus the working directory and the
+// source's path when it may include other files. Entries with includes list
+// them with their hashes and only hit while all of those still match, which
+// an include that could not be read never does.
+// Entries are written to a temporary file and renamed into place, so any
+// number of processes and threads may share one directory. The counters and
+// the total size are kept in a stats file that flush() updates under a lock,
+// evicting the least recently used entries once the total goes over maxBytes.
+class AssemblyCache {
+  public:
+    AssemblyCache(const char *directory, uint64_t maxBytes);
+
+    // path is where the source came from (see Assembler::path)
+    bool lookup(const char *path, const char *source, size_t length,
+                AssembleStatus *status, Output *output,
+                Diagnostics *diagnostics,
+                std::vector<Dependency> *dependencies);
+    void store(const char *path, const char *source, size_t length,
+               AssembleStatus status, const Output &output,
+               const Diagnostics &diagnostics,
+               const std::vector<Dependency> &dependencies);
+    // returns false when the directory can not be used at all
+    bool flush(CacheStats *totals);
+
+  private:
+    std::string directory;
+    uint64_t maxBytes;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> addedBytes;
+    std::atomic<uint64_t> temporaries;
+
+    std::string entryPath(uint64_t key);
+    uint64_t evict(uint64_t bytes);
+};
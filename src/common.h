@@ -2,10 +2,22 @@
 
 #include <stdbool.h>
 
-bool isHex(char c);
-bool isDigit(char c);
-bool isBinary(char c);
-bool isUpper(char c);
-bool isLower(char c);
-bool isAlpha(char c);
-bool isAlphaNumeric(char c);
\ No newline at end of file
+// these run once per source byte in the scanner, so they live in the header
+// where they can be inlined
+
+inline bool isHex(char c) {
+    return ('0' <= c && c <= '9') || ('a' <= c && c <= 'f') ||
+           ('A' <= c && c <= 'F');
+}
+
+inline bool isBinary(char c) { return ('0' == c || '1' == c); }
+
+inline bool isDigit(char c) { return ('0' <= c && c <= '9'); }
+
+inline bool isUpper(char c) { return ('A' <= c && c <= 'Z'); }
+
+inline bool isLower(char c) { return ('a' <= c && c <= 'z'); }
+
+inline bool isAlpha(char c) { return (isLower(c) || isUpper(c)); }
+
+inline bool isAlphaNumeric(char c) { return (isAlpha(c) || isDigit(c)); }
@@ -1,40 +1,78 @@
 #include <cctype>
 #include <cstdarg>
 #include <cstdint>
-#include <map>
+#include <cstring>
 #include <stdint.h>
+#include <memory>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "common.h"
 #include "compiler.h"
+#include "include.h"
+#include "object.h"
+#include "stats.h"
 #include "token.h"
 
-Compiler::Compiler(std::vector<Token> *tokens, char *buffer, int bufferLength) {
+// what peek() and friends see past the last token, an empty newline at
+// the end of the source so errors there point at the last line
+static Token endOfInput(size_t sourceLength) {
+    Token token;
+    token.start = sourceLength;
+    token.symbol = NO_SYMBOL;
+    token.length = 0;
+    token.type = TOKEN_NEWLINE;
+    return token;
+}
+
+Compiler::Compiler(TokenList *tokens, const char *source,
+                   size_t sourceLength, SymbolTable *symbols, Arena *arena,
+                   Diagnostics *diagnostics)
+    : lines(source, sourceLength), fixups(arena), exports(arena),
+      definitions(arena), written(arena) {
     this->tokens = tokens;
+    this->source = source;
+    this->sourceLength = sourceLength;
+    this->end = endOfInput(sourceLength);
+    this->symbols = symbols;
+    this->diagnostics = diagnostics;
     this->currentToken = 0;
+    this->endToken = tokens->size();
     this->currentAddress = 512;
     this->previous = nullptr;
-    this->buffer = buffer;
-    this->bufferLength = bufferLength;
+    this->buffer = nullptr;
+    this->bufferLength = 0;
     this->currentBufferPos = 0;
+    this->hadError = false;
+    this->resumable = false;
+    this->sourceMap = nullptr;
+    this->relocatable = false;
+    this->stats = nullptr;
+    this->panicMode = false;
 }
 
 Token *Compiler::advance() {
     if (!isAtEnd())
         currentToken++;
-    previous = &tokens->at(currentToken - 1);
+    previous = currentToken > 0 ? &(*tokens)[currentToken - 1] : &end;
     return previous;
 }
 
 Token *Compiler::peek() {
-    Token *token = &tokens->at(currentToken);
-    return token;
+    return (size_t)currentToken < tokens->size() ? &(*tokens)[currentToken]
+                                                 : &end;
 }
 
-Token *Compiler::peekNext() { return &tokens->at(currentToken + 1); }
+Token *Compiler::peekNext() {
+    return (size_t)currentToken + 1 < tokens->size()
+               ? &(*tokens)[currentToken + 1]
+               : &end;
+}
 
-bool Compiler::isAtEnd() { return currentToken >= (int)tokens->size(); }
+bool Compiler::isAtEnd() { return currentToken >= endToken; }
 
 bool Compiler::check(TokenType type) {
     if (isAtEnd())
@@ -60,15 +98,83 @@ bool Compiler::matchBetween(TokenType start, TokenType end) {
     return false;
 }
 
-void Compiler::writeInstruction(uint16_t instruction) {
-    if (currentBufferPos + 1 > (bufferLength - 2)) {
-        fprintf(stderr, "Assembly file is too large.\n");
-        exit(65);
+// identifiers normally get their id from the scanner, tokens that were
+// scanned without a symbol table are interned here on first use
+int Compiler::symbolOf(Token *identifier) {
+    if (identifier->symbol == NO_SYMBOL) {
+        identifier->symbol =
+            symbols->intern(text(identifier), identifier->length);
+    }
+    return identifier->symbol;
+}
+
+uint16_t Compiler::labelAddress(Token *label) {
+    Symbol *symbol = symbols->get(symbolOf(label));
+    // an object keeps every reference, the linker moves them all
+    if (symbol->kind == SYMBOL_LABEL && !relocatable) {
+        return symbol->value;
+    }
+
+    // forward reference, the address field is patched once all labels are
+    // known (see resolveFixups)
+    Fixup fixup;
+    fixup.bufferPos = currentBufferPos;
+    fixup.label = *label;
+    fixups.push_back(fixup);
+    return 0;
+}
+
+void Compiler::resolveFixups() {
+    PhaseTimer timer(stats, PHASE_FIXUPS);
+    for (Fixup &fixup : fixups) {
+        Symbol *symbol = symbols->get(fixup.label.symbol);
+        if (symbol->kind != SYMBOL_LABEL && relocatable) {
+            continue; // imported from another module
+        } else if (symbol->kind != SYMBOL_LABEL) {
+            panicMode = false;
+            error(&fixup.label, "Label '%.*s' does not exist.",
+                  fixup.label.length, text(&fixup.label));
+            continue;
+        }
+        // the field may still hold an address from before a recompile()
+        uint16_t addr = symbol->value;
+        buffer[fixup.bufferPos] = (buffer[fixup.bufferPos] & 0xF0) |
+                                  (uint8_t)((addr >> 8) & 0x0F);
+        buffer[fixup.bufferPos + 1] = (uint8_t)addr;
     }
-    buffer[currentBufferPos] = (uint8_t)(instruction >> 8);
-    currentBufferPos++;
-    buffer[currentBufferPos] = (uint8_t)(instruction);
-    currentBufferPos++;
+}
+
+// once the program no longer fits the buffer the rest is still checked and
+// counted, but nothing more is written and the overflow is reported once.
+// Instructions and .dw words are big endian.
+bool Compiler::writeBytes(uint16_t value, int size) {
+    bool fits = currentBufferPos + size <= bufferLength;
+    if (fits) {
+        if (size == 2)
+            buffer[currentBufferPos] = (uint8_t)(value >> 8);
+        buffer[currentBufferPos + size - 1] = (uint8_t)value;
+        for (int i = 0; resumable && i < size; i++)
+            written.push_back(previous->start);
+    } else if (currentBufferPos <= bufferLength) {
+        error(previous, "Assembly file is too large.");
+    } else {
+        hadError = true;
+    }
+    currentBufferPos += size;
+    currentAddress += size;
+    return fits;
+}
+
+void Compiler::define(Token *identifier, SymbolKind kind, uint16_t value) {
+    Symbol *symbol = symbols->get(symbolOf(identifier));
+    if (resumable) {
+        definitions.push_back({identifier->symbol, identifier->start,
+                               symbol->kind, symbol->value,
+                               symbol->definedAt});
+    }
+    symbol->kind = kind;
+    symbol->value = value;
+    symbol->definedAt = identifier->start;
 }
 
 bool Compiler::consume(TokenType type, const char *message) {
@@ -82,16 +188,24 @@ bool Compiler::consume(TokenType type, const char *message) {
 void Compiler::error(Token *token, const char *message, ...) {
     if (!panicMode) {
         panicMode = true;
-        fprintf(stderr, "[line %d] ", token->line);
         va_list args;
         va_start(args, message);
-        vfprintf(stderr, message, args);
+        const char *file;
+        int line = lineOf(token, &file);
+        diagnostics->addvIn(file, line, message, args);
         va_end(args);
-        fprintf(stderr, "\n");
     }
     hadError = true;
 }
 
+// file is empty for the source itself
+int Compiler::lineOf(Token *token, const char **file) {
+    if (sourceMap != nullptr)
+        return sourceMap->locate(token->start, file);
+    *file = "";
+    return lines.lineOf(token->start);
+}
+
 uint8_t charToHex(char c) {
     if (isDigit(c)) {
         return c - '0';
@@ -103,450 +217,256 @@ uint8_t charToHex(char c) {
     return 199; // something went wrong
 }
 
-uint16_t decodeBinaryLiteral(Token *literal) {
+// both take the literal including its '%' or '$' prefix
+uint16_t decodeBinaryLiteral(const char *literal, int length) {
     uint16_t num = 0;
-    for (int i = 1; i < literal->length; i++) {
-        char c = *(literal->start + i);
-        num |= (c << (i - 1));
+    for (int i = 1; i < length; i++) {
+        num = (num << 1) | (literal[i] - '0');
     }
     return num;
 }
 
-uint16_t decodeHexLiteral(Token *literal) {
+uint16_t decodeHexLiteral(const char *literal, int length) {
     uint16_t num = 0;
-    for (int i = 1; i < literal->length; i++) {
-        uint8_t c = charToHex(*(literal->start + i));
-        num |= (c << ((literal->length - (i + 1)) * 4));
+    for (int i = 1; i < length; i++) {
+        uint8_t c = charToHex(literal[i]);
+        num |= (c << ((length - (i + 1)) * 4));
     }
     return num;
 }
 
-uint16_t Compiler::decodeLiteral(Token *literal, uint8_t binaryLength,
-                                 uint8_t hexLength, const char *message) {
-    uint16_t num = 0;
-    if (*literal->start == '%' && (literal->length - 1) == binaryLength) {
-        num = decodeBinaryLiteral(literal);
-    } else if (*literal->start == '$' && (literal->length - 1) == hexLength) {
-        num = decodeHexLiteral(literal);
-    } else {
-        error(previous, message);
+// literals have to spell out exactly as many digits as the operand has bits
+bool Compiler::decodeLiteral(Token *literal, uint8_t bits, uint16_t *value) {
+    const char *start = text(literal);
+    if (*start == '%' && (literal->length - 1) == bits) {
+        *value = decodeBinaryLiteral(start, literal->length);
+        return true;
+    } else if (*start == '$' && (literal->length - 1) * 4 == bits) {
+        *value = decodeHexLiteral(start, literal->length);
+        return true;
     }
-    return num;
-}
-
-inline uint16_t extractXReg(Token *token) {
-    return (uint16_t)(charToHex(*(token->start + 1)) << 8);
+    return false;
 }
 
-inline uint16_t extractYReg(Token *token) {
-    return (uint16_t)(charToHex(*(token->start + 1)) << 4);
-}
-void Compiler::instructionStmt() {
-#define CONSUME(tType, message)                                                \
-    if (!consume(tType, message)) {                                            \
-        break;                                                                 \
-    }
-#define DOUBLE_REG_INST(inst, opcode)                                          \
-    CONSUME(TOKEN_V_REGISTER, "inst expects V register as first argument.");   \
-    uint16_t x = extractXReg(previous);                                        \
-    CONSUME(TOKEN_COMMA, "Exptected ',' between arguments.");                  \
-    CONSUME(TOKEN_V_REGISTER, "inst expects V register as second argument.");  \
-    uint16_t y = extractYReg(previous);                                        \
-    writeInstruction(opcode + x + y);                                          \
-    return;
-
-#define SINGLE_REG_INST(inst, opcode)                                          \
-    CONSUME(TOKEN_V_REGISTER, "inst expects V register as argument.");         \
-    uint16_t x = extractXReg(previous);                                        \
-    writeInstruction(opcode + x);                                              \
-    return;
-
-    Token *token = previous;
-    switch (token->type) {
-        case TOKEN_INST_CLS: {
-            if (matchBetween(TOKEN_COMMA, TOKEN_INST_LDV)) {
-                error(previous, "Instruction 'CLS' has no arguments.");
-            }
-            writeInstruction(0x00E0);
-            return;
+bool Compiler::operandValue(Token *instruction, OperandKind kind,
+                            Token *operand, uint16_t *value) {
+    uint8_t bits = operandFields[kind].bits;
+    switch (operand->type) {
+        case TOKEN_V_REGISTER: {
+            *value = charToHex(*(text(operand) + 1));
         } break;
-        case TOKEN_INST_RET: {
-            if (matchBetween(TOKEN_COMMA, TOKEN_INST_LDV)) {
-                error(previous, "Instruction 'RET' has no arguments.");
-            }
-            writeInstruction(0x00EE);
-            return;
+        case TOKEN_I_REGISTER: {
+            *value = 0;
         } break;
-        case TOKEN_INST_JP: {
-            uint16_t val = 0;
-            if (match(TOKEN_IDENTIFIER)) {
-                std::string label(previous->start, previous->length);
-                if (labelMap.find(label) != labelMap.end()) {
-                    val = labelMap.at(label);
-                } else {
-                    error(previous, "Label '%.*s' does not exist.",
-                          previous->length, previous->start);
-                    break;
-                }
-            } else if (match(TOKEN_LITERAL)) {
-                val = decodeLiteral(previous, 12, 3,
-                                    "JP instruction expects 12 bit literal.");
-            } else {
-                error(advance(), "'JP' expects either label, literal or V "
-                                 "register as first argument.");
-                break;
-            }
-            writeInstruction(0x1000 + val);
-        } break;
-        case TOKEN_INST_JPO: {
-            uint16_t val = 0;
-            if (match(TOKEN_IDENTIFIER)) {
-                std::string label(previous->start, previous->length);
-                if (labelMap.find(label) != labelMap.end()) {
-                    val = labelMap.at(label);
-                } else {
-                    error(previous, "Label '%.*s' does not exist.",
-                          previous->length, previous->start);
-                    break;
-                }
-            } else if (match(TOKEN_LITERAL)) {
-                val =
-                    decodeLiteral(previous, 12, 3,
-                                  "'JPO' instruction expects 12 bit literal.");
-            } else {
-                error(advance(), "'JPO' expects either label, literal or V "
-                                 "register as first argument.");
-                break;
+        case TOKEN_LITERAL: {
+            if (!decodeLiteral(operand, bits, value)) {
+                error(operand, "'%.*s' expects %d bit literal.",
+                      instruction->length, text(instruction), bits);
+                return false;
             }
-            writeInstruction(0xB000 + val);
         } break;
-        case TOKEN_INST_CALL: {
-            uint16_t val = 0;
-            if (match(TOKEN_IDENTIFIER)) {
-                std::string label(previous->start, previous->length);
-                if (labelMap.find(label) != labelMap.end()) {
-                    val = labelMap.at(label);
-                } else {
-                    error(previous, "Label '%.*s' does not exist.",
-                          previous->length, previous->start);
-                    break;
+        case TOKEN_IDENTIFIER: {
+            Symbol *symbol = symbols->get(symbolOf(operand));
+            // variables only exist from their assignment onwards
+            if (symbol->kind != SYMBOL_VARIABLE ||
+                symbol->definedAt > operand->start) {
+                if (kind == OPERAND_ADDR) {
+                    *value = labelAddress(operand);
+                    return true;
                 }
-            } else if (match(TOKEN_LITERAL)) {
-                val = decodeLiteral(previous, 12, 3,
-                                    "JMP instruction expects 12 bit address.");
+                error(operand, "Variable '%.*s' does not exist.",
+                      operand->length, text(operand));
+                return false;
+            } else if (symbol->value >= (1 << bits)) {
+                error(operand,
+                      "Value %d in variable '%.*s' is too large "
+                      "(expected %d bit).",
+                      symbol->value, operand->length, text(operand), bits);
+                return false;
             }
-            writeInstruction(0x2000 + val);
-            return;
+            *value = symbol->value;
         } break;
-        case TOKEN_INST_SE: {
-            CONSUME(TOKEN_V_REGISTER,
-                    "SE instruction expects V register as first argument.");
-            uint16_t x = extractXReg(previous);
-            CONSUME(TOKEN_COMMA, "Expected ',' between instruction arguments.");
-            if (match(TOKEN_V_REGISTER)) {
-                uint16_t y = extractYReg(previous);
-                writeInstruction(0x5000 + x + y);
-                return;
-            } else if (match(TOKEN_LITERAL)) {
-                uint16_t val = decodeLiteral(previous, 8, 2, "Expected byte.");
-                writeInstruction(0x3000 + x + val);
-                return;
-            } else if (match(TOKEN_IDENTIFIER)) {
-                uint16_t val = 0;
-                std::string str(previous->start, previous->length);
-                if ((variableMap.find(str) == variableMap.end())) {
-                    error(previous, "Variable '%.*s' does not exist.",
-                          previous->length, previous->start);
-                    break;
-                } else if (variableMap.at(str) > 255) {
-                    error(previous,
-                          "Value %d in variable '%.*s' is too large "
-                          "(expected byte).",
-                          variableMap.at(str), previous->length,
-                          previous->start);
-                    break;
-                }
-                val = variableMap.at(str);
-                writeInstruction(0x3000 + x + val);
-            } else {
-                error(advance(), "Instruction SE expects either V register or "
-                                 "literal as second argument.");
-                break;
-            }
-        } break;
-        case TOKEN_INST_SNE: {
-            CONSUME(TOKEN_V_REGISTER,
-                    "'SNE' instruction expects V register as first argument.");
-            uint16_t x = extractXReg(previous);
-            CONSUME(TOKEN_COMMA, "Expected ',' between instruction arguments.");
-            if (match(TOKEN_V_REGISTER)) {
-                uint16_t y = extractYReg(previous);
-                writeInstruction(0x9000 + x + y);
-                return;
-            } else if (match(TOKEN_LITERAL)) {
-                uint16_t val = decodeLiteral(previous, 8, 2, "Expected byte.");
-                writeInstruction(0x4000 + x + val);
-                return;
-            } else if (match(TOKEN_IDENTIFIER)) {
-                uint16_t val = 0;
-                std::string str(previous->start, previous->length);
-                if ((variableMap.find(str) == variableMap.end())) {
-                    error(previous, "Variable '%.*s' does not exist.",
-                          previous->length, previous->start);
-                    break;
-                } else if (variableMap.at(str) > 255) {
-                    error(previous,
-                          "Value %d in variable '%.*s' is too large "
-                          "(expected byte).",
-                          variableMap.at(str), previous->length,
-                          previous->start);
-                    break;
-                }
-                val = variableMap.at(str);
-                writeInstruction(0x4000 + x + val);
-            } else {
-                error(advance(), "Instruction SNE expects either V register or "
-                                 "literal as second argument.");
-                break;
-            }
+        default: {
+            error(operand, "Unexpected argument.");
+            return false;
         } break;
-        case TOKEN_INST_LD: {
-            if (match(TOKEN_V_REGISTER)) {
-                uint16_t x = extractXReg(previous);
-                CONSUME(TOKEN_COMMA, "Expected ',' between arguments.");
-                if (match(TOKEN_LITERAL)) {
-                    uint16_t byte =
-                        decodeLiteral(previous, 8, 2, "Expected byte literal.");
-                    writeInstruction(0x6000 + x + byte);
-                    return;
-                } else if (match(TOKEN_IDENTIFIER)) {
-                    std::string str(previous->start, previous->length);
-                    if ((variableMap.find(str) == variableMap.end()) ||
-                        variableMap.at(str) > 255) {
-                        error(previous, "Value in variable is too large for LD "
-                                        "(expected byte).");
-                        break;
-                    }
-                    writeInstruction(0x6000 + x + variableMap.at(str));
-                    return;
-                } else if (match(TOKEN_V_REGISTER)) {
-                    uint16_t y = extractYReg(previous);
-                    writeInstruction(0x8000 + x + y);
-                    return;
-                } else {
-                    error(advance(), "Expected V register or byte literal.");
-                    break;
-                }
-            } else if (match(TOKEN_I_REGISTER)) {
-                CONSUME(TOKEN_COMMA, "Expected ',' between arguments.");
-                uint16_t addr = 0;
-                if (match(TOKEN_LITERAL)) {
-                    addr = decodeLiteral(previous, 12, 3,
-                                         "LD expects 12 bit literal.");
-                } else if (match(TOKEN_IDENTIFIER)) {
-                    std::string str(previous->start, previous->length);
-                    if ((variableMap.find(str) == variableMap.end())) {
-                        error(previous, "Variable '%.*s' does not exist.",
-                              previous->length, previous->start);
-                        break;
-                    } else if (variableMap.at(str) > 4095) {
-                        error(previous,
-                              "Value %d in variable '%.*s' is too large "
-                              "(expected 12 bit).",
-                              variableMap.at(str), previous->length,
-                              previous->start);
-                        break;
-                    }
-                    addr = variableMap.at(str);
-                }
-                writeInstruction(0xA000 + addr);
+    }
+    return true;
+}
+
+// parses the comma separated arguments and encodes them with the matching
+// row of the encoding table (see encoding.cpp)
+void Compiler::instructionStmt() {
+    Token *instruction = previous;
+    Token *operands[MAX_OPERANDS];
+    TokenType operandTypes[MAX_OPERANDS];
+    int operandCount = 0;
+
+    if (!isAtEnd() && !check(TOKEN_NEWLINE)) {
+        do {
+            if (operandCount == MAX_OPERANDS) {
+                error(peek(), "Too many arguments for '%.*s'.",
+                      instruction->length, text(instruction));
+                synchronize();
                 return;
-            } else {
-                error(advance(),
-                      "LD expects either V or I register as first argument.");
-                break;
             }
-        } break;
-        case TOKEN_INST_ADD: {
-            if (match(TOKEN_V_REGISTER)) {
-                uint16_t x = extractXReg(previous);
-                CONSUME(TOKEN_COMMA, "Expected ',' between arguments.");
-                if (match(TOKEN_V_REGISTER)) {
-                    uint16_t y = extractYReg(previous);
-                    writeInstruction(0x8004 + x + y);
-                    return;
-                } else if (match(TOKEN_LITERAL)) {
-                    uint16_t byte =
-                        decodeLiteral(previous, 8, 2, "Expected byte literal.");
-                    writeInstruction(0x7000 + x + byte);
-                    return;
-                } else if (match(TOKEN_IDENTIFIER)) {
-                    std::string str(previous->start, previous->length);
-                    if ((variableMap.find(str) == variableMap.end()) ||
-                        variableMap.at(str) > 255) {
-                        error(previous,
-                              "Value in variable is too large for ADD "
-                              "(expected byte).");
-                        break;
-                    }
-                    writeInstruction(0x7000 + x + variableMap.at(str));
-                    return;
-                } else {
-                    error(advance(), "Expected V register, byte literal or "
-                                     "byte identifier.");
-                    break;
-                }
-            } else if (match(TOKEN_I_REGISTER)) {
-                CONSUME(TOKEN_COMMA, "Expected ',' between arguments.");
-                CONSUME(TOKEN_V_REGISTER,
-                        "ADD expects V register after I register argument.");
-                uint16_t x = extractXReg(previous);
-                writeInstruction(0xF01E + x);
+            if (!matchBetween(TOKEN_IDENTIFIER, TOKEN_I_REGISTER)) {
+                // a missing argument must not swallow the newline, the
+                // statement would run on into the next line
+                Token *at = isAtEnd() || check(TOKEN_NEWLINE) ? previous
+                                                               : advance();
+                error(at, "Expected register, literal or identifier "
+                          "as argument.");
+                synchronize();
                 return;
             }
-        } break;
-        case TOKEN_INST_OR: {
-            DOUBLE_REG_INST(OR, 0x8001);
-        } break;
-        case TOKEN_INST_AND: {
-            DOUBLE_REG_INST(AND, 0x8002);
-        } break;
-        case TOKEN_INST_XOR: {
-            DOUBLE_REG_INST(XOR, 0x8003);
-        } break;
-        case TOKEN_INST_SUB: {
-            DOUBLE_REG_INST(SUB, 0x8005);
-        } break;
-        case TOKEN_INST_SHR: {
-            SINGLE_REG_INST(SHR, 0x8006);
-        } break;
-        case TOKEN_INST_SUBN: {
-            DOUBLE_REG_INST(SUBN, 0x8007);
-        } break;
-        case TOKEN_INST_SHL: {
-            SINGLE_REG_INST(SHL, 0x800E);
-        } break;
-        case TOKEN_INST_RND: {
-            CONSUME(TOKEN_V_REGISTER,
-                    "RND expects V register as first argument.");
-            uint16_t x = extractXReg(previous);
-            CONSUME(TOKEN_COMMA, "Expected ',' between arguments.");
-            uint16_t byte = 0;
-            if (match(TOKEN_LITERAL)) {
-                byte = decodeLiteral(previous, 8, 2, "RND expects byte.");
-            } else if (match(TOKEN_IDENTIFIER)) {
-                std::string str(previous->start, previous->length);
-                if ((variableMap.find(str) == variableMap.end())) {
-                    error(previous, "Variable '%.*s' does not exist.",
-                          previous->length, previous->start);
-                    break;
-                } else if (variableMap.at(str) > 4095) {
-                    error(previous,
-                          "Value %d in variable '%.*s' is too large "
-                          "(expected byte).",
-                          variableMap.at(str), previous->length,
-                          previous->start);
-                    break;
-                }
-                byte = variableMap.at(str);
-            }
-            writeInstruction(0xC000 + x + byte);
-            return;
-        } break;
-        case TOKEN_INST_DRW: {
-            CONSUME(TOKEN_V_REGISTER,
-                    "DRW expects V register as first argument.");
-            uint16_t x = extractXReg(previous);
-            CONSUME(TOKEN_COMMA, "Expect ',' between arguments.");
-            CONSUME(TOKEN_V_REGISTER,
-                    "DRW expects V register as second argument.");
-            uint16_t y = extractYReg(previous);
-            CONSUME(TOKEN_COMMA, "Expect ',' between arguments.");
-            uint16_t nibble = 0;
-            if (match(TOKEN_LITERAL)) {
-                nibble = decodeLiteral(previous, 4, 1,
-                                       "'DRW' expected 4 bit literal.");
-            } else if (match(TOKEN_IDENTIFIER)) {
-                std::string identifier(previous->start, previous->length);
-                if (variableMap.find(identifier) == variableMap.end()) {
-                    error(previous, "Variable '%.*s' does not exist.",
-                          previous->length, previous->start);
-                    break;
-                } else if (variableMap.at(identifier) > 15) {
-                    error(previous,
-                          "'DRW' expects nibble, value in variable '%.*s' is "
-                          "too large.",
-                          previous->length, previous->start);
-                    break;
-                } else {
-                    nibble = variableMap.at(identifier);
-                }
-            } else {
-                error(advance(), "'DRW' expects 4 bit variable or literal as "
-                                 "third argument.");
-                break;
-            }
-            writeInstruction(0xD000 + x + y + nibble);
+            operands[operandCount] = previous;
+            operandTypes[operandCount] = (TokenType)previous->type;
+            operandCount++;
+        } while (match(TOKEN_COMMA));
+
+        if (!isAtEnd() && !check(TOKEN_NEWLINE)) {
+            error(advance(), "Expected ',' between arguments.");
+            synchronize();
             return;
-        } break;
-        case TOKEN_INST_SKP: {
-            SINGLE_REG_INST(SKP, 0xE09E);
-        } break;
-        case TOKEN_INST_SKNP: {
-            SINGLE_REG_INST(SKNP, 0xE0A1);
-        } break;
-        case TOKEN_INST_GDT: {
-            SINGLE_REG_INST(GDT, 0xF007);
-        } break;
-        case TOKEN_INST_WKP: {
-            SINGLE_REG_INST(WKP, 0xF00A);
-        } break;
-        case TOKEN_INST_SDT: {
-            SINGLE_REG_INST(SDT, 0xF015);
-        } break;
-        case TOKEN_INST_SST: {
-            SINGLE_REG_INST(SST, 0xF018);
-        } break;
-        case TOKEN_INST_FNT: {
-            SINGLE_REG_INST(FNT, 0xF029);
-        } break;
-        case TOKEN_INST_BCD: {
-            SINGLE_REG_INST(BCD, 0xF033);
-        } break;
-        case TOKEN_INST_STV: {
-            SINGLE_REG_INST(STV, 0xF055);
-        } break;
-        case TOKEN_INST_LDV: {
-            SINGLE_REG_INST(LDV, 0xF065);
-        } break;
-        default: {
-            error(previous, "Unexpected token while parsing instruction.");
-        } break;
+        }
     }
 
-    // this code block SHOULD only be accesible if an error occured
-    // in all other cases we should return from the function within the switch
-    // statement
-    if (panicMode) {
-        // hadError = true;
+    const Encoding *encoding = findEncoding((TokenType)instruction->type,
+                                            operandTypes, operandCount);
+    if (encoding == nullptr) {
+        error(instruction, "Invalid arguments for '%.*s'.",
+              instruction->length, text(instruction));
         synchronize();
+        return;
+    }
+
+    size_t fixupCount = fixups.size();
+    uint16_t opcode = encoding->opcode;
+    for (int i = 0; i < operandCount; i++) {
+        OperandKind kind = encoding->operands[i];
+        uint16_t value = 0;
+        if (!operandValue(instruction, kind, operands[i], &value)) {
+            // drop a label reference recorded for this instruction
+            fixups.resize(fixupCount);
+            synchronize();
+            return;
+        }
+        opcode |= value << operandFields[kind].shift;
+    }
+    if (!writeBytes(opcode, 2)) {
+        fixups.resize(fixupCount);
     }
-    return;
-#undef CONSUME
-#undef DOUBLE_REG_INST
-#undef SINGLE_REG_INST
 }
 
 void Compiler::assignStmt(Token *identifier) {
-    std::string variable(identifier->start, identifier->length);
+    Symbol *symbol = symbols->get(symbolOf(identifier));
+    if (symbol->kind == SYMBOL_LABEL) {
+        error(identifier, "'%.*s' is already defined as a label.",
+              identifier->length, text(identifier));
+        return;
+    }
     if (consume(TOKEN_LITERAL, "Can only assign literals to variable")) {
         uint16_t val = 0;
-        if (*previous->start == '%') {
-            val = decodeBinaryLiteral(previous);
-        } else if (*previous->start == '$') {
-            val = decodeHexLiteral(previous);
+        const char *start = text(previous);
+        if (*start == '%') {
+            val = decodeBinaryLiteral(start, previous->length);
+        } else if (*start == '$') {
+            val = decodeHexLiteral(start, previous->length);
+        }
+        if (symbol->kind == SYMBOL_VARIABLE &&
+            symbol->definedAt == identifier->start) {
+            return; // already assigned by layout()
+        }
+        define(identifier, SYMBOL_VARIABLE, val);
+    }
+}
+
+static bool isNamed(const char *text, Token *token, const char *name) {
+    return token->length == strlen(name) &&
+           memcmp(text, name, token->length) == 0;
+}
+
+// the bytes a `.db` or `.dw` starting with name writes, 0 for other
+// directives
+static int dataSize(const char *source, Token *name, int count) {
+    int size;
+    if (isNamed(source + name->start, name, "db"))
+        size = 1;
+    else if (isNamed(source + name->start, name, "dw"))
+        size = 2;
+    else
+        return 0;
+    int values = 0;
+    for (int i = 1; i < count && name[i].type != TOKEN_NEWLINE; i++) {
+        values += name[i].type != TOKEN_COMMA;
+    }
+    return values * size;
+}
+
+// `.db value, ...` and `.dw value, ...` write bytes and words as they are,
+// e.g. sprites or what the disassembler could not decode
+void Compiler::dataStmt(Token *directive, int size) {
+    OperandKind kind = size == 2 ? OPERAND_WORD : OPERAND_BYTE;
+    do {
+        if (!match(TOKEN_LITERAL) && !match(TOKEN_IDENTIFIER)) {
+            error(isAtEnd() || check(TOKEN_NEWLINE) ? previous : peek(),
+                  "Expected a literal or variable after '.%.*s'.",
+                  directive->length, text(directive));
+            synchronize();
+            return;
         }
-        variableMap[variable] = val;
+        uint16_t value = 0;
+        if (!operandValue(directive, kind, previous, &value)) {
+            synchronize();
+            return;
+        }
+        writeBytes(value, size);
+    } while (match(TOKEN_COMMA));
+    if (!isAtEnd() && !check(TOKEN_NEWLINE)) {
+        error(advance(), "Expected ',' between values.");
+        synchronize();
+    }
+}
+
+// `.export label, ...` makes labels visible to other modules when linking
+void Compiler::directiveStmt() {
+    Token *dot = previous;
+    if (!match(TOKEN_IDENTIFIER)) {
+        error(dot, "Expected a directive after '.'.");
+        synchronize();
+        return;
+    }
+    Token *directive = previous;
+    if (isNamed(text(directive), directive, "db") ||
+        isNamed(text(directive), directive, "dw")) {
+        dataStmt(directive, text(directive)[1] == 'w' ? 2 : 1);
+        return;
+    }
+    if (!isNamed(text(directive), directive, "export")) {
+        // .include is spliced out before compiling, unless the caller does
+        // not follow includes (e.g. --watch)
+        error(directive, isNamed(text(directive), directive, "include")
+                             ? "'.include' is not supported here."
+                             : "Unknown directive '.%.*s'.",
+              directive->length, text(directive));
+        synchronize();
+        return;
+    }
+
+    do {
+        if (!match(TOKEN_IDENTIFIER)) {
+            error(isAtEnd() || check(TOKEN_NEWLINE) ? previous : peek(),
+                  "Expected a label to export.");
+            synchronize();
+            return;
+        }
+        symbolOf(previous);
+        exports.push_back(*previous);
+    } while (match(TOKEN_COMMA));
+    if (!isAtEnd() && !check(TOKEN_NEWLINE)) {
+        error(advance(), "Expected ',' between labels.");
+        synchronize();
     }
 }
 
@@ -554,6 +474,7 @@ void Compiler::synchronize() {
     while (!isAtEnd() && !match(TOKEN_NEWLINE)) {
         advance();
     }
+    panicMode = false;
 }
 
 void Compiler::statement() {
@@ -562,47 +483,316 @@ void Compiler::statement() {
         if (match(TOKEN_EQUAL)) {
             assignStmt(identifier);
         } else if (match(TOKEN_COLON)) {
-            // labelStmt();
+            labelStmt(identifier);
         } else {
             error(peek(), "Expected either '=' or ':' for identifier '%.*s'.",
-                  identifier->length, identifier->start);
+                  identifier->length, text(identifier));
             synchronize();
         }
     } else if (matchBetween(TOKEN_INST_CLS, TOKEN_INST_LDV)) {
         instructionStmt();
     } else if (match(TOKEN_NEWLINE)) {
         panicMode = false;
+    } else if (match(TOKEN_DOT)) {
+        directiveStmt();
     } else {
         error(peek(), "Line has to start with identifier or instruction.");
         synchronize();
     }
 }
 
-// loops over the token vector and resolves labels to actual
-// addresses in memory
-void Compiler::labelPass() {
+void Compiler::labelStmt(Token *identifier) {
+    Symbol *symbol = symbols->get(symbolOf(identifier));
+    if (symbol->kind != SYMBOL_UNDEFINED) {
+        // a definition placed by layout() is this very statement
+        if (symbol->definedAt != identifier->start) {
+            error(identifier, "'%.*s' is already defined.",
+                  identifier->length, text(identifier));
+        }
+        return;
+    }
+    define(identifier, SYMBOL_LABEL, currentAddress);
+}
+
+// exports have to name labels, wherever they are defined
+void Compiler::checkExports() {
+    for (Token &label : exports) {
+        if (symbols->get(label.symbol)->kind != SYMBOL_LABEL) {
+            panicMode = false;
+            error(&label, "Label '%.*s' does not exist.", label.length,
+                  text(&label));
+        }
+    }
+}
+
+// Everything the linker needs from a relocatable compile(). A fixup was
+// kept for every label reference, those of local labels are patched already.
+void Compiler::fillObject(ObjectFile *object) {
+    object->clear();
+    int length = currentBufferPos < bufferLength ? currentBufferPos
+                                                 : bufferLength;
+    object->code.assign(buffer, buffer + length);
+    object->files.push_back("");
+    std::unordered_map<std::string, uint32_t> fileIds = {{"", 0}};
+    auto locate = [&](Token *token) {
+        const char *file;
+        uint32_t line = lineOf(token, &file);
+        auto id = fileIds.emplace(file, object->files.size());
+        if (id.second)
+            object->files.push_back(file);
+        return ObjectLocation{id.first->second, line};
+    };
+
+    std::unordered_set<int> exported;
+    for (Token &label : exports) {
+        Symbol *symbol = symbols->get(label.symbol);
+        if (!exported.insert(label.symbol).second)
+            continue;
+        object->exports.push_back({std::string(text(&label), label.length),
+                                   (uint16_t)(symbol->value - 512),
+                                   locate(&label)});
+    }
+
+    std::unordered_map<int, uint32_t> imports;
+    for (Fixup &fixup : fixups) {
+        uint32_t import = LOCAL_LABEL;
+        if (symbols->get(fixup.label.symbol)->kind != SYMBOL_LABEL) {
+            auto id = imports.emplace(fixup.label.symbol,
+                                      object->imports.size());
+            if (id.second) {
+                object->imports.push_back(
+                    std::string(text(&fixup.label), fixup.label.length));
+            }
+            import = id.first->second;
+        }
+        object->relocations.push_back(
+            {(uint16_t)fixup.bufferPos, import, locate(&fixup.label)});
+    }
+}
+
+// assembles in a single pass over the tokens, label references that can not
+// be resolved yet are recorded as fixups and patched at the end
+int Compiler::compile(char *buffer, int bufferLength, int threads) {
+    this->buffer = buffer;
+    this->bufferLength = bufferLength;
+
+    if (threads > 1 && !relocatable &&
+        (int)tokens->size() >= PARALLEL_EMIT_THRESHOLD) {
+        std::vector<Statement> statements;
+        if (layout(&statements)) {
+            return emitParallel(&statements, threads);
+        }
+        symbols->clearDefinitions();
+    }
+
     while (!isAtEnd()) {
-        if (match(TOKEN_IDENTIFIER)) {
-            if (check(TOKEN_COLON)) {
-                std::string str(previous->start, previous->length);
-                labelMap[str] = currentAddress;
-                advance();
+        statement();
+    }
+    resolveFixups();
+    checkExports();
+    return currentBufferPos;
+}
+
+// Picks an error free, resumable compile() of an earlier version of the
+// source back up at token, the first token of the first edited line. That
+// line starts at offset in both versions, so whatever the old version
+// defined, referred to or wrote before it still holds. Everything from there
+// on is undone and compiled again. The buffer must still hold the previous
+// output.
+int Compiler::recompile(TokenList *tokens, const char *source,
+                        size_t sourceLength, int token, uint32_t offset) {
+    this->tokens = tokens;
+    this->source = source;
+    this->sourceLength = sourceLength;
+    this->end = endOfInput(sourceLength);
+    this->lines = LineIndex(source, sourceLength);
+    while (!definitions.empty() && definitions.back().offset >= offset) {
+        const Definition &definition = definitions.back();
+        Symbol *symbol = symbols->get(definition.symbol);
+        symbol->kind = definition.kind;
+        symbol->value = definition.value;
+        symbol->definedAt = definition.definedAt;
+        definitions.pop_back();
+    }
+    while (!fixups.empty() && fixups.back().label.start >= offset)
+        fixups.pop_back();
+    while (!exports.empty() && exports.back().start >= offset)
+        exports.pop_back();
+    while (!written.empty() && written.back() >= offset)
+        written.pop_back();
+    int pos = written.size();
+
+    this->currentToken = token;
+    this->endToken = tokens->size();
+    this->currentBufferPos = pos;
+    this->currentAddress = 512 + pos;
+    this->previous = nullptr;
+    this->hadError = false;
+    this->panicMode = false;
+    while (!isAtEnd()) {
+        statement();
+    }
+    resolveFixups();
+    checkExports();
+    return currentBufferPos;
+}
+
+// Compiles tokens as the scanner pushes them into ring. They are taken a
+// line at a time, so a statement is never split, and tokens only ever holds
+// the current line.
+int Compiler::compileStream(TokenRing *ring, char *buffer, int bufferLength) {
+    this->buffer = buffer;
+    this->bufferLength = bufferLength;
+
+    Token token;
+    bool more = true;
+    while (more) {
+        tokens->clear();
+        while ((more = ring->pop(&token))) {
+            tokens->push_back(token);
+            if (token.type == TOKEN_NEWLINE)
+                break;
+        }
+        currentToken = 0;
+        endToken = tokens->size();
+        while (!isAtEnd()) {
+            statement();
+        }
+    }
+    resolveFixups();
+    checkExports();
+    return currentBufferPos;
+}
+
+// Every instruction is two bytes and data directives count their values, so
+// one walk over the statement heads gives each statement its output position
+// and defines every label and variable. Gives up (returns false) when that
+// would not match the single pass, i.e. when a name is defined twice or the
+// program does not fit.
+bool Compiler::layout(std::vector<Statement> *statements) {
+    for (Token &token : *tokens) {
+        if (token.type == TOKEN_IDENTIFIER)
+            symbolOf(&token); // workers must not intern concurrently
+    }
+
+    // workers start at line boundaries, where the single pass is never in
+    // the middle of a statement or in panic mode
+    int pos = 0;
+    int count = tokens->size();
+    bool lineStart = true;
+    for (int i = 0; i < count;) {
+        Token *head = &(*tokens)[i];
+        if (lineStart)
+            statements->push_back({i, pos});
+        lineStart = false;
+
+        if (head->type == TOKEN_NEWLINE) {
+            lineStart = true;
+            i++;
+            continue;
+        }
+
+        // labels and assignments may be followed by another statement on the
+        // same line, everything else runs until the newline
+        if (head->type == TOKEN_IDENTIFIER && i + 1 < count) {
+            Token *next = &(*tokens)[i + 1];
+            Symbol *symbol = symbols->get(head->symbol);
+            bool isLabel = next->type == TOKEN_COLON;
+            bool isVariable = next->type == TOKEN_EQUAL && i + 2 < count &&
+                              (*tokens)[i + 2].type == TOKEN_LITERAL;
+            if ((isLabel || isVariable) && symbol->kind != SYMBOL_UNDEFINED)
+                return false;
+
+            if (isLabel) {
+                symbol->kind = SYMBOL_LABEL;
+                symbol->value = 512 + pos;
+                symbol->definedAt = head->start;
+                i += 2;
+                continue;
+            } else if (isVariable) {
+                Token *literal = &(*tokens)[i + 2];
+                const char *start = text(literal);
+                symbol->kind = SYMBOL_VARIABLE;
+                symbol->value =
+                    *start == '%'
+                        ? decodeBinaryLiteral(start, literal->length)
+                        : decodeHexLiteral(start, literal->length);
+                symbol->definedAt = head->start;
+                i += 3;
+                continue;
             }
-        } else if (matchBetween(TOKEN_INST_CLS, TOKEN_INST_LDV)) {
-            currentAddress += 2;
+        } else if (head->type >= TOKEN_INST_CLS &&
+                   head->type <= TOKEN_INST_LDV) {
+            pos += 2;
+        } else if (head->type == TOKEN_DOT && i + 1 < count) {
+            pos += dataSize(source, &(*tokens)[i + 1], count - i - 1);
         }
-        synchronize();
+
+        while (i < count && (*tokens)[i].type != TOKEN_NEWLINE)
+            i++;
     }
-    currentToken = 0;
-    currentAddress = 512;
-    previous = nullptr;
+    return pos <= bufferLength;
 }
 
-int Compiler::compile() {
-    labelPass();
+void Compiler::emitRange() {
     while (!isAtEnd()) {
         statement();
     }
-    buffer[currentBufferPos] = EOF;
+}
+
+// Splits the statements into one contiguous range per thread. Each worker
+// encodes straight into its slice of the buffer and keeps its own errors and
+// unresolved labels, which are merged in source order afterwards.
+int Compiler::emitParallel(std::vector<Statement> *statements, int threads) {
+    int count = statements->size();
+    if (threads > count)
+        threads = count;
+
+    std::vector<std::unique_ptr<Arena>> arenas;
+    std::vector<std::unique_ptr<Diagnostics>> workerDiagnostics;
+    std::vector<std::unique_ptr<Compiler>> workers;
+    for (int w = 0; w < threads; w++) {
+        const Statement &first = (*statements)[(long)count * w / threads];
+        int end = w + 1 == threads
+                      ? (int)tokens->size()
+                      : (*statements)[(long)count * (w + 1) / threads].token;
+
+        arenas.push_back(std::make_unique<Arena>());
+        workerDiagnostics.push_back(std::make_unique<Diagnostics>());
+        auto worker = std::make_unique<Compiler>(
+            tokens, source, sourceLength, symbols, arenas.back().get(),
+            workerDiagnostics.back().get());
+        worker->sourceMap = sourceMap;
+        worker->buffer = buffer;
+        worker->bufferLength = bufferLength;
+        worker->currentToken = first.token;
+        worker->endToken = end;
+        worker->currentBufferPos = first.bufferPos;
+        worker->currentAddress = 512 + first.bufferPos;
+        workers.push_back(std::move(worker));
+    }
+
+    std::vector<std::thread> pool;
+    for (int w = 1; w < threads; w++) {
+        pool.emplace_back(&Compiler::emitRange, workers[w].get());
+    }
+    workers[0]->emitRange();
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+
+    for (auto &worker : workers) {
+        diagnostics->append(*worker->diagnostics);
+        fixups.insert(fixups.end(), worker->fixups.begin(),
+                      worker->fixups.end());
+        exports.insert(exports.end(), worker->exports.begin(),
+                       worker->exports.end());
+        hadError = hadError || worker->hadError;
+    }
+    resolveFixups();
+    checkExports();
+
+    currentToken = endToken;
+    currentBufferPos = workers.back()->currentBufferPos;
     return currentBufferPos;
 }
@@ -1,41 +1,112 @@
 #pragma once
 
-#include <map>
+#include <stddef.h>
 #include <stdint.h>
-#include <string>
 #include <vector>
 
+#include "arena.h"
+#include "diagnostics.h"
+#include "encoding.h"
+#include "lines.h"
+#include "symbols.h"
 #include "token.h"
+#include "tokenring.h"
+
+typedef struct {
+    int bufferPos;
+    Token label; // a copy, the token list may be gone when it is patched
+} Fixup;
+
+// what a symbol was before a statement at offset defined it, recompile()
+// undoes definitions from the back
+typedef struct {
+    int symbol;
+    uint32_t offset;
+    SymbolKind kind;
+    uint16_t value;
+    uint32_t definedAt;
+} Definition;
+
+typedef struct {
+    int token;
+    int bufferPos;
+} Statement;
+
+// both take the literal including its '%' or '$' prefix
+uint16_t decodeBinaryLiteral(const char *literal, int length);
+uint16_t decodeHexLiteral(const char *literal, int length);
+
+// below this many tokens the emission stage is not worth splitting
+#define PARALLEL_EMIT_THRESHOLD (1 << 18)
+
+class ObjectFile;
+class SourceMap;
+class Stats;
 
 class Compiler {
   public:
-    Compiler(std::vector<Token> *tokens, char *buffer, int bufferLength);
-    int compile();
+    Compiler(TokenList *tokens, const char *source, size_t sourceLength,
+             SymbolTable *symbols, Arena *arena, Diagnostics *diagnostics);
+    // returns the number of bytes written to buffer
+    int compile(char *buffer, int bufferLength, int threads = 1);
+    // the same, for tokens that are still being scanned (see pipeline.h)
+    int compileStream(TokenRing *ring, char *buffer, int bufferLength);
+    // continues a compile() on an edited source (see watch.cpp)
+    int recompile(TokenList *tokens, const char *source, size_t sourceLength,
+                  int token, uint32_t offset);
     bool hadError;
+    bool resumable; // keeps what recompile() needs
+    // for sources with includes spliced in, see include.h
+    SourceMap *sourceMap;
+    // leaves labels that are not defined to the linker (see object.h)
+    bool relocatable;
+    Stats *stats; // times resolving fixups for --stats
+    // after a relocatable compile(), the code is copied from buffer
+    void fillObject(ObjectFile *object);
 
   private:
     int currentAddress;
     int currentToken;
+    int endToken;
     Token *previous;
+    Token end; // returned by peek() at the end of the tokens
     char *buffer;
     int currentBufferPos;
     int bufferLength;
 
-    std::vector<Token> *tokens;
-    std::map<std::string, uint16_t> labelMap;
-    std::map<std::string, uint16_t> variableMap;
+    TokenList *tokens;
+    const char *source;
+    size_t sourceLength;
+    LineIndex lines;
+    SymbolTable *symbols;
+    Diagnostics *diagnostics;
+    std::vector<Fixup, ArenaAllocator<Fixup>> fixups;
+    std::vector<Token, ArenaAllocator<Token>> exports;
+    // only kept when resumable
+    std::vector<Definition, ArenaAllocator<Definition>> definitions;
+    // the statement offset of every byte written
+    std::vector<uint32_t, ArenaAllocator<uint32_t>> written;
 
     bool panicMode;
     void error(Token *token, const char *message, ...);
+    int lineOf(Token *token, const char **file);
+
+    const char *text(Token *token) { return source + token->start; }
 
-    void writeInstruction(uint16_t instruction);
+    bool writeBytes(uint16_t value, int size);
+    void define(Token *identifier, SymbolKind kind, uint16_t value);
+    int symbolOf(Token *identifier);
+    uint16_t labelAddress(Token *label);
+    void resolveFixups();
+    void checkExports();
 
     Token *advance();
     Token *peek();
     Token *peekNext();
     bool consume(TokenType type, const char *message);
-    uint16_t decodeLiteral(Token *literal, uint8_t binaryLength,
-                           uint8_t hexLength, const char *message);
+    bool decodeLiteral(Token *literal, uint8_t bits, uint16_t *value);
+    bool operandValue(Token *instruction, OperandKind kind, Token *operand,
+                      uint16_t *value);
 
     bool isAtEnd();
     bool check(TokenType type);
@@ -46,8 +117,13 @@ class Compiler {
     void statement();
     void instructionStmt();
     void assignStmt(Token *identifier);
-
-    void labelPass();
+    void labelStmt(Token *identifier);
+    void directiveStmt();
+    void dataStmt(Token *directive, int size);
 
     void synchronize();
+
+    bool layout(std::vector<Statement> *statements);
+    int emitParallel(std::vector<Statement> *statements, int threads);
+    void emitRange();
 };
@@ -0,0 +1,49 @@
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "diagnostics.h"
+
+void Diagnostics::add(int line, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    addv(line, format, args);
+    va_end(args);
+}
+
+void Diagnostics::addv(int line, const char *format, va_list args) {
+    addvIn("", line, format, args);
+}
+
+void Diagnostics::addIn(const char *file, int line, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    addvIn(file, line, format, args);
+    va_end(args);
+}
+
+void Diagnostics::addvIn(const char *file, int line, const char *format,
+                         va_list args) {
+    char message[256];
+    vsnprintf(message, sizeof(message), format, args);
+    list.push_back({line, message, file});
+}
+
+void Diagnostics::append(const Diagnostics &other) {
+    list.insert(list.end(), other.list.begin(), other.list.end());
+}
+
+void Diagnostics::print(FILE *stream) {
+    for (const Diagnostic &diagnostic : list) {
+        if (diagnostic.line == 0) {
+            // about a whole file, e.g. from the linker
+            fprintf(stream, "[%s] %s\n", diagnostic.file.c_str(),
+                    diagnostic.message.c_str());
+        } else if (diagnostic.file.empty()) {
+            fprintf(stream, "[line %d] %s\n", diagnostic.line,
+                    diagnostic.message.c_str());
+        } else {
+            fprintf(stream, "[%s line %d] %s\n", diagnostic.file.c_str(),
+                    diagnostic.line, diagnostic.message.c_str());
+        }
+    }
+}
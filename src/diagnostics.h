@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+typedef struct {
+    int line;
+    std::string message;
+    std::string file; // of an included file, empty for the source itself
+} Diagnostic;
+
+// Collects errors instead of printing them right away, so work that runs out
+// of order (e.g. on several threads) can still report in source order.
+class Diagnostics {
+  public:
+    std::vector<Diagnostic> list;
+
+    void add(int line, const char *format, ...);
+    void addv(int line, const char *format, va_list args);
+    void addIn(const char *file, int line, const char *format, ...);
+    void addvIn(const char *file, int line, const char *format,
+                va_list args);
+    void append(const Diagnostics &other);
+    void print(FILE *stream);
+    bool empty() { return list.empty(); }
+    void clear() { list.clear(); }
+};
@@ -0,0 +1,114 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#include "disassembler.h"
+#include "encoding.h"
+#include "mnemonic.h"
+
+// "at" and three letters
+#define LABEL_LENGTH 5
+
+static void labelName(uint16_t address, char *name) {
+    name[0] = 'a';
+    name[1] = 't';
+    for (int i = 0; i < 3; i++) {
+        name[2 + i] = 'a' + ((address >> ((2 - i) * 4)) & 0xF);
+    }
+    name[LABEL_LENGTH] = '\0';
+}
+
+static uint16_t wordAt(const char *rom, size_t word) {
+    return (uint8_t)rom[word * 2] << 8 | (uint8_t)rom[word * 2 + 1];
+}
+
+// the word an address field points at, or -1 when it is outside the ROM or
+// between two words
+static long labelIndex(uint16_t address, size_t words) {
+    if (address < 512 || (address - 512) % 2 != 0 ||
+        (size_t)(address - 512) / 2 > words)
+        return -1;
+    return (address - 512) / 2;
+}
+
+static void appendOperand(std::string *source, OperandKind kind,
+                          uint16_t opcode, size_t words) {
+    const OperandField &field = operandFields[kind];
+    uint16_t value = (opcode >> field.shift) & ((1 << field.bits) - 1);
+    char text[16];
+    switch (kind) {
+        case OPERAND_VX:
+        case OPERAND_VY:
+            snprintf(text, sizeof(text), "V%X", value);
+            break;
+        case OPERAND_I:
+            snprintf(text, sizeof(text), "I");
+            break;
+        case OPERAND_NIBBLE:
+            snprintf(text, sizeof(text), "$%X", value);
+            break;
+        case OPERAND_BYTE:
+            snprintf(text, sizeof(text), "$%02X", value);
+            break;
+        case OPERAND_ADDR:
+            if (labelIndex(value, words) >= 0)
+                labelName(value, text);
+            else
+                snprintf(text, sizeof(text), "$%03X", value);
+            break;
+        case OPERAND_WORD:
+            snprintf(text, sizeof(text), "$%04X", value);
+            break;
+    }
+    *source += text;
+}
+
+void disassemble(const char *rom, size_t length, std::string *source) {
+    size_t words = length / 2;
+    source->clear();
+    source->reserve(words * 16);
+
+    // one more for a label just past the last word
+    std::vector<bool> labeled(words + 1);
+    for (size_t w = 0; w < words; w++) {
+        uint16_t opcode = wordAt(rom, w);
+        const Encoding *encoding = decodeOpcode(opcode);
+        for (int i = 0; encoding != nullptr && i < encoding->operandCount;
+             i++) {
+            long index = labelIndex(opcode & 0xFFF, words);
+            if (encoding->operands[i] == OPERAND_ADDR && index >= 0)
+                labeled[index] = true;
+        }
+    }
+
+    char line[32];
+    for (size_t w = 0; w <= words; w++) {
+        if (labeled[w]) {
+            labelName(512 + w * 2, line);
+            *source += line;
+            *source += ":\n";
+        }
+        if (w == words)
+            break;
+
+        uint16_t opcode = wordAt(rom, w);
+        const Encoding *encoding = decodeOpcode(opcode);
+        if (encoding == nullptr) {
+            snprintf(line, sizeof(line), "    .dw $%04X\n", opcode);
+            *source += line;
+            continue;
+        }
+        *source += "    ";
+        *source += mnemonicName(encoding->mnemonic);
+        for (int i = 0; i < encoding->operandCount; i++) {
+            *source += i == 0 ? " " : ", ";
+            appendOperand(source, encoding->operands[i], opcode, words);
+        }
+        *source += '\n';
+    }
+    if (length % 2 != 0) {
+        snprintf(line, sizeof(line), "    .db $%02X\n",
+                 (uint8_t)rom[length - 1]);
+        *source += line;
+    }
+}
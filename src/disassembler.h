@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stddef.h>
+#include <string>
+
+// Turns a ROM back into a source that assembles to the same bytes. Words
+// that are no instruction become `.dw`, an odd last byte `.db`. Addresses
+// that point at a word of the ROM, or just past its end, get a label named
+// "at" and the address with its hex digits spelled 'a' to 'p' (identifiers
+// can not contain digits), e.g. atcaa for 0x200.
+void disassemble(const char *rom, size_t length, std::string *source);
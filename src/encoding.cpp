@@ -0,0 +1,171 @@
+#include "encoding.h"
+#include "token.h"
+
+#define MNEMONIC_COUNT (TOKEN_INST_LDV - TOKEN_INST_CLS + 1)
+
+constexpr OperandField operandFields[] = {
+    {8, 4}, // OPERAND_VX
+    {4, 4}, // OPERAND_VY
+    {0, 0}, // OPERAND_I
+    {0, 4}, // OPERAND_NIBBLE
+    {0, 8}, // OPERAND_BYTE
+    {0, 12}, // OPERAND_ADDR
+    {0, 16}, // OPERAND_WORD
+};
+
+// all forms of one mnemonic have to be next to each other
+static constexpr Encoding encodings[] = {
+    {TOKEN_INST_CLS, 0x00E0, 0, {}},
+    {TOKEN_INST_RET, 0x00EE, 0, {}},
+    {TOKEN_INST_JP, 0x1000, 1, {OPERAND_ADDR}},
+    {TOKEN_INST_JPO, 0xB000, 1, {OPERAND_ADDR}},
+    {TOKEN_INST_CALL, 0x2000, 1, {OPERAND_ADDR}},
+    {TOKEN_INST_SE, 0x5000, 2, {OPERAND_VX, OPERAND_VY}},
+    {TOKEN_INST_SE, 0x3000, 2, {OPERAND_VX, OPERAND_BYTE}},
+    {TOKEN_INST_SNE, 0x9000, 2, {OPERAND_VX, OPERAND_VY}},
+    {TOKEN_INST_SNE, 0x4000, 2, {OPERAND_VX, OPERAND_BYTE}},
+    {TOKEN_INST_LD, 0x8000, 2, {OPERAND_VX, OPERAND_VY}},
+    {TOKEN_INST_LD, 0x6000, 2, {OPERAND_VX, OPERAND_BYTE}},
+    {TOKEN_INST_LD, 0xA000, 2, {OPERAND_I, OPERAND_ADDR}},
+    {TOKEN_INST_ADD, 0x8004, 2, {OPERAND_VX, OPERAND_VY}},
+    {TOKEN_INST_ADD, 0x7000, 2, {OPERAND_VX, OPERAND_BYTE}},
+    {TOKEN_INST_ADD, 0xF01E, 2, {OPERAND_I, OPERAND_VX}},
+    {TOKEN_INST_AND, 0x8002, 2, {OPERAND_VX, OPERAND_VY}},
+    {TOKEN_INST_OR, 0x8001, 2, {OPERAND_VX, OPERAND_VY}},
+    {TOKEN_INST_XOR, 0x8003, 2, {OPERAND_VX, OPERAND_VY}},
+    {TOKEN_INST_SUB, 0x8005, 2, {OPERAND_VX, OPERAND_VY}},
+    {TOKEN_INST_SHR, 0x8006, 1, {OPERAND_VX}},
+    {TOKEN_INST_SHR, 0x8006, 2, {OPERAND_VX, OPERAND_VY}},
+    {TOKEN_INST_SUBN, 0x8007, 2, {OPERAND_VX, OPERAND_VY}},
+    {TOKEN_INST_SHL, 0x800E, 1, {OPERAND_VX}},
+    {TOKEN_INST_SHL, 0x800E, 2, {OPERAND_VX, OPERAND_VY}},
+    {TOKEN_INST_RND, 0xC000, 2, {OPERAND_VX, OPERAND_BYTE}},
+    {TOKEN_INST_DRW, 0xD000, 3, {OPERAND_VX, OPERAND_VY, OPERAND_NIBBLE}},
+    {TOKEN_INST_SKP, 0xE09E, 1, {OPERAND_VX}},
+    {TOKEN_INST_SKNP, 0xE0A1, 1, {OPERAND_VX}},
+    {TOKEN_INST_GDT, 0xF007, 1, {OPERAND_VX}},
+    {TOKEN_INST_WKP, 0xF00A, 1, {OPERAND_VX}},
+    {TOKEN_INST_SDT, 0xF015, 1, {OPERAND_VX}},
+    {TOKEN_INST_SST, 0xF018, 1, {OPERAND_VX}},
+    {TOKEN_INST_FNT, 0xF029, 1, {OPERAND_VX}},
+    {TOKEN_INST_BCD, 0xF033, 1, {OPERAND_VX}},
+    {TOKEN_INST_STV, 0xF055, 1, {OPERAND_VX}},
+    {TOKEN_INST_LDV, 0xF065, 1, {OPERAND_VX}},
+};
+
+#define ENCODING_COUNT (int)(sizeof(encodings) / sizeof(encodings[0]))
+
+typedef struct {
+    uint8_t first;
+    uint8_t count;
+} EncodingRange;
+
+typedef struct {
+    EncodingRange ranges[MNEMONIC_COUNT];
+    bool grouped;
+} EncodingIndex;
+
+static constexpr EncodingIndex buildEncodingIndex() {
+    EncodingIndex index = {};
+    index.grouped = true;
+    for (int i = 0; i < ENCODING_COUNT; i++) {
+        EncodingRange &range =
+            index.ranges[encodings[i].mnemonic - TOKEN_INST_CLS];
+        if (range.count == 0) {
+            range.first = i;
+        } else if (range.first + range.count != i) {
+            index.grouped = false;
+        }
+        range.count++;
+    }
+    for (const EncodingRange &range : index.ranges) {
+        if (range.count == 0) {
+            index.grouped = false;
+        }
+    }
+    return index;
+}
+
+static constexpr EncodingIndex encodingIndex = buildEncodingIndex();
+static_assert(encodingIndex.grouped,
+              "every mnemonic needs a contiguous, non-empty set of forms");
+
+static bool accepts(OperandKind kind, TokenType type) {
+    switch (kind) {
+        case OPERAND_VX:
+        case OPERAND_VY:
+            return type == TOKEN_V_REGISTER;
+        case OPERAND_I:
+            return type == TOKEN_I_REGISTER;
+        case OPERAND_NIBBLE:
+        case OPERAND_BYTE:
+        case OPERAND_ADDR:
+        case OPERAND_WORD:
+            return type == TOKEN_LITERAL || type == TOKEN_IDENTIFIER;
+    }
+    return false;
+}
+
+const Encoding *findEncoding(TokenType mnemonic, const TokenType *operands,
+                             int operandCount) {
+    const EncodingRange &range =
+        encodingIndex.ranges[mnemonic - TOKEN_INST_CLS];
+    for (int i = range.first; i < range.first + range.count; i++) {
+        const Encoding *encoding = &encodings[i];
+        if (encoding->operandCount != operandCount)
+            continue;
+
+        bool matches = true;
+        for (int j = 0; j < operandCount && matches; j++) {
+            matches = accepts(encoding->operands[j], operands[j]);
+        }
+        if (matches)
+            return encoding;
+    }
+    return nullptr;
+}
+
+// no instruction encodes the word, it is data
+#define NO_ENCODING 0xFF
+
+typedef struct {
+    uint8_t encodings[1 << 16]; // index into encodings or NO_ENCODING
+} DecodeTable;
+
+// the bits of the opcode that the operands of the form fill in
+static constexpr uint16_t operandBits(const Encoding &encoding) {
+    uint16_t bits = 0;
+    for (int i = 0; i < encoding.operandCount; i++) {
+        const OperandField &field = operandFields[encoding.operands[i]];
+        bits |= ((1 << field.bits) - 1) << field.shift;
+    }
+    return bits;
+}
+
+// Every form marks all the words it can assemble to, from the last form to
+// the first so that the first in table order wins. That keeps 'SHR Vx' for
+// 8x06 and leaves 'SHR Vx, Vy' the words with a Vy.
+static constexpr DecodeTable buildDecodeTable() {
+    DecodeTable table = {};
+    for (uint8_t &entry : table.encodings) {
+        entry = NO_ENCODING;
+    }
+    for (int i = ENCODING_COUNT - 1; i >= 0; i--) {
+        uint16_t bits = operandBits(encodings[i]);
+        // every subset of the operand bits, down to none
+        for (uint16_t value = bits;; value = (value - 1) & bits) {
+            table.encodings[encodings[i].opcode | value] = i;
+            if (value == 0)
+                break;
+        }
+    }
+    return table;
+}
+
+static constexpr DecodeTable decodeTable = buildDecodeTable();
+static_assert(ENCODING_COUNT < NO_ENCODING, "encodings do not fit a byte");
+
+const Encoding *decodeOpcode(uint16_t opcode) {
+    uint8_t index = decodeTable.encodings[opcode];
+    return index == NO_ENCODING ? nullptr : &encodings[index];
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "token.h"
+
+#define MAX_OPERANDS 3
+
+typedef enum {
+    OPERAND_VX,     // V register in bits 8-11
+    OPERAND_VY,     // V register in bits 4-7
+    OPERAND_I,      // I register, does not show up in the opcode
+    OPERAND_NIBBLE, // 4 bit literal or variable in bits 0-3
+    OPERAND_BYTE,   // 8 bit literal or variable in bits 0-7
+    OPERAND_ADDR,   // 12 bit literal, variable or label in bits 0-11
+    OPERAND_WORD,   // 16 bit literal or variable, only for .dw
+} OperandKind;
+
+typedef struct {
+    uint8_t shift;
+    uint8_t bits;
+} OperandField;
+
+// One accepted operand pattern of an instruction. Instructions with several
+// forms (e.g. 'LD Vx, Vy' and 'LD Vx, byte') have one row per form.
+typedef struct {
+    TokenType mnemonic;
+    uint16_t opcode;
+    uint8_t operandCount;
+    OperandKind operands[MAX_OPERANDS];
+} Encoding;
+
+extern const OperandField operandFields[];
+
+// Finds the form of the instruction that accepts the given operand token
+// types, nullptr if there is none.
+const Encoding *findEncoding(TokenType mnemonic, const TokenType *operands,
+                             int operandCount);
+
+// The form that assembles to opcode, nullptr for words that are no
+// instruction. One lookup in a table built at compile time.
+const Encoding *decodeOpcode(uint16_t opcode);
@@ -0,0 +1,170 @@
+#include <string.h>
+
+#include "common.h"
+#include "fastscan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FASTSCAN_X86
+#include <immintrin.h>
+#endif
+
+static const char *skipBlanksScalar(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    return p;
+}
+
+static const char *skipHexScalar(const char *p, const char *end) {
+    while (p < end && isHex(*p))
+        p++;
+    return p;
+}
+
+static const char *skipBinaryScalar(const char *p, const char *end) {
+    while (p < end && isBinary(*p))
+        p++;
+    return p;
+}
+
+// glibc already picks a vectorized memchr for the running CPU
+static const char *findNewlineMemchr(const char *p, const char *end) {
+    const char *newline = (const char *)memchr(p, '\n', end - p);
+    return newline == nullptr ? end : newline;
+}
+
+static const char *findNewlineScalar(const char *p, const char *end) {
+    while (p < end && *p != '\n')
+        p++;
+    return p;
+}
+
+#ifdef FASTSCAN_X86
+
+// Every kernel classifies a whole vector into a bit mask of bytes that
+// continue the run and stops at the first zero bit. The last partial vector
+// is left to the scalar loop so loads never cross the end of the source,
+// which may be the end of a mapping.
+
+// bytes in [lo, lo + n) without unsigned compares: min(v - lo, n - 1) equals
+// v - lo exactly when v - lo < n
+static inline __m128i inRange128(__m128i v, char lo, char n) {
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(n - 1)),
+                          shifted);
+}
+
+static inline __m128i blank128(__m128i v) {
+    return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                        _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+}
+
+static inline __m128i hex128(__m128i v) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    return _mm_or_si128(inRange128(v, '0', 10), inRange128(lower, 'a', 6));
+}
+
+static inline __m128i binary128(__m128i v) { return inRange128(v, '0', 2); }
+
+#define SSE2_KERNEL(name, classify, scalar)                                    \
+    static const char *name(const char *p, const char *end) {                 \
+        while (end - p >= 16) {                                                \
+            __m128i v = _mm_loadu_si128((const __m128i *)p);                   \
+            unsigned stop = ~_mm_movemask_epi8(classify(v)) & 0xFFFF;          \
+            if (stop != 0)                                                     \
+                return p + __builtin_ctz(stop);                                \
+            p += 16;                                                           \
+        }                                                                      \
+        return scalar(p, end);                                                 \
+    }
+
+SSE2_KERNEL(skipBlanksSse2, blank128, skipBlanksScalar)
+SSE2_KERNEL(skipHexSse2, hex128, skipHexScalar)
+SSE2_KERNEL(skipBinarySse2, binary128, skipBinaryScalar)
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static inline __m256i inRange256(__m256i v, char lo, char n) {
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(
+        _mm256_min_epu8(shifted, _mm256_set1_epi8(n - 1)), shifted);
+}
+
+AVX2 static inline __m256i blank256(__m256i v) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                           _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')));
+}
+
+AVX2 static inline __m256i hex256(__m256i v) {
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    return _mm256_or_si256(inRange256(v, '0', 10), inRange256(lower, 'a', 6));
+}
+
+AVX2 static inline __m256i binary256(__m256i v) {
+    return inRange256(v, '0', 2);
+}
+
+#define AVX2_KERNEL(name, classify, fallback)                                  \
+    AVX2 static const char *name(const char *p, const char *end) {            \
+        while (end - p >= 32) {                                                \
+            __m256i v = _mm256_loadu_si256((const __m256i *)p);                \
+            unsigned stop = ~(unsigned)_mm256_movemask_epi8(classify(v));      \
+            if (stop != 0)                                                     \
+                return p + __builtin_ctz(stop);                                \
+            p += 32;                                                           \
+        }                                                                      \
+        return fallback(p, end);                                               \
+    }
+
+AVX2_KERNEL(skipBlanksAvx2, blank256, skipBlanksSse2)
+AVX2_KERNEL(skipHexAvx2, hex256, skipHexSse2)
+AVX2_KERNEL(skipBinaryAvx2, binary256, skipBinarySse2)
+
+#endif
+
+static const ScanKernels scalarKernels = {skipBlanksScalar, skipHexScalar,
+                                          skipBinaryScalar, findNewlineScalar};
+#ifdef FASTSCAN_X86
+static const ScanKernels sse2Kernels = {skipBlanksSse2, skipHexSse2,
+                                        skipBinarySse2, findNewlineMemchr};
+static const ScanKernels avx2Kernels = {skipBlanksAvx2, skipHexAvx2,
+                                        skipBinaryAvx2, findNewlineMemchr};
+#endif
+
+ScanBackend detectScanBackend() {
+#ifdef FASTSCAN_X86
+    static const ScanBackend backend =
+        __builtin_cpu_supports("avx2")   ? SCAN_AVX2
+        : __builtin_cpu_supports("sse2") ? SCAN_SSE2
+                                         : SCAN_SCALAR;
+    return backend;
+#else
+    return SCAN_SCALAR;
+#endif
+}
+
+// falls back to the best supported backend if the requested one is not
+const ScanKernels *scanKernels(ScanBackend backend) {
+    if (backend > detectScanBackend())
+        backend = detectScanBackend();
+    switch (backend) {
+#ifdef FASTSCAN_X86
+        case SCAN_AVX2:
+            return &avx2Kernels;
+        case SCAN_SSE2:
+            return &sse2Kernels;
+#endif
+        default:
+            return &scalarKernels;
+    }
+}
+
+const char *scanBackendName(ScanBackend backend) {
+    switch (backend) {
+        case SCAN_AVX2:
+            return "avx2";
+        case SCAN_SSE2:
+            return "sse2";
+        default:
+            return "scalar";
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+typedef enum {
+    SCAN_SCALAR,
+    SCAN_SSE2,
+    SCAN_AVX2,
+} ScanBackend;
+
+// Each kernel returns the first position in [p, end) that does not belong to
+// the run it skips, or end.
+typedef struct {
+    const char *(*skipBlanks)(const char *p, const char *end);
+    const char *(*skipHex)(const char *p, const char *end);
+    const char *(*skipBinary)(const char *p, const char *end);
+    const char *(*findNewline)(const char *p, const char *end);
+} ScanKernels;
+
+// the best backend the CPU supports, detected once
+ScanBackend detectScanBackend();
+const ScanKernels *scanKernels(ScanBackend backend);
+
+const char *scanBackendName(ScanBackend backend);
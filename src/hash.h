@@ -0,0 +1,8 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// XXH64, a fast non-cryptographic hash for cache keys (see cache.h). Gives
+// the same values as the reference implementation.
+uint64_t xxh64(const void *data, size_t length, uint64_t seed);
@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "hash.h"
+#include "include.h"
+#include "io.h"
+#include "scanner.h"
+
+IncludedFile::IncludedFile(const std::string &path, const char *data,
+                           size_t length)
+    : path(path), text(data, length), tokens(&arena) {
+    hash = xxh64(data, length, 0);
+    if (length > MAX_SOURCE_LENGTH) {
+        diagnostics.addIn(path.c_str(), 1, "File is too large.");
+        hadError = true;
+        return;
+    }
+    Scanner scanner(text.data(), text.size(), nullptr, &diagnostics);
+    scanner.scan(&tokens);
+    hadError = scanner.hadError;
+    for (Diagnostic &diagnostic : diagnostics.list) {
+        diagnostic.file = path;
+    }
+}
+
+std::shared_ptr<const IncludedFile>
+IncludeCache::get(const std::string &path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+        return nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto entry = entries.find(path);
+        if (entry != entries.end() && entry->second.size == st.st_size &&
+            entry->second.modified.tv_sec == st.st_mtim.tv_sec &&
+            entry->second.modified.tv_nsec == st.st_mtim.tv_nsec)
+            return entry->second.file;
+    }
+
+    // scanned outside the lock, other threads may include other files
+    SourceFile source;
+    if (!openSource(path.c_str(), &source))
+        return nullptr;
+    uint64_t hash = xxh64(source.data, source.length, 0);
+    std::shared_ptr<const IncludedFile> file;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto entry = entries.find(path);
+        if (entry != entries.end() && entry->second.file->hash == hash &&
+            entry->second.file->text.size() == source.length)
+            file = entry->second.file; // only touched
+    }
+    if (file == nullptr) {
+        file = std::make_shared<const IncludedFile>(path, source.data,
+                                                    source.length);
+    }
+    closeSource(&source);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[path] = {file, st.st_mtim, st.st_size};
+    return file;
+}
+
+int SourceMap::addFile(const std::string &name, const char *text,
+                       size_t length) {
+    std::lock_guard<std::mutex> lock(mutex);
+    names.push_back(name);
+    lines.push_back(std::make_unique<LineIndex>(text, length));
+    return names.size() - 1;
+}
+
+void SourceMap::addSegment(uint32_t start, int file, uint32_t fileStart) {
+    std::lock_guard<std::mutex> lock(mutex);
+    segments.push_back({start, file, fileStart});
+}
+
+int SourceMap::lineIn(int file, uint32_t fileOffset, const char **name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    *name = names[file].c_str();
+    return lines[file]->lineOf(fileOffset);
+}
+
+int SourceMap::locate(uint32_t offset, const char **name) {
+    Segment segment;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // the last segment starting at or before offset, empty ones that
+        // start at the same offset hold no tokens
+        auto next = std::upper_bound(
+            segments.begin(), segments.end(), offset,
+            [](uint32_t offset, const Segment &segment) {
+                return offset < segment.start;
+            });
+        if (next == segments.begin()) {
+            *name = "";
+            return 1;
+        }
+        segment = *(next - 1);
+    }
+    return lineIn(segment.file, segment.fileStart + offset - segment.start,
+                  name);
+}
+
+typedef struct {
+    IncludeCache *cache;
+    ExpandedSource *expanded;
+    Diagnostics *diagnostics;
+    std::vector<std::string> stack; // files being spliced, to catch cycles
+    bool hadError;
+} Expansion;
+
+static void error(Expansion *expansion, int file, uint32_t offset,
+                  const char *format, ...) {
+    const char *name;
+    int line = expansion->expanded->map.lineIn(file, offset, &name);
+    va_list args;
+    va_start(args, format);
+    expansion->diagnostics->addvIn(name, line, format, args);
+    va_end(args);
+    expansion->hadError = true;
+}
+
+static std::string directoryOf(const std::string &path) {
+    size_t slash = path.rfind('/');
+    return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+}
+
+static bool isDirective(const char *text, const Token *tokens, size_t i,
+                        size_t count, const char *name) {
+    size_t length = strlen(name);
+    return tokens[i].type == TOKEN_DOT &&
+           (i == 0 || tokens[i - 1].type == TOKEN_NEWLINE) && i + 1 < count &&
+           tokens[i + 1].type == TOKEN_IDENTIFIER &&
+           tokens[i + 1].length == length &&
+           memcmp(text + tokens[i + 1].start, name, length) == 0;
+}
+
+// .db, .dw and .export leave the source as it is
+bool hasIncludes(const char *source, const TokenList &tokens) {
+    for (size_t i = 0; i < tokens.size(); i++) {
+        if (isDirective(source, tokens.data(), i, tokens.size(), "include"))
+            return true;
+    }
+    return false;
+}
+
+static void splice(Expansion *expansion, int file, const std::string &path,
+                   const char *text, size_t length, const Token *tokens,
+                   size_t count);
+
+static void include(Expansion *expansion, int file, const Token *name,
+                    const std::string &path) {
+    ExpandedSource *expanded = expansion->expanded;
+    if (expansion->stack.size() >= MAX_INCLUDE_DEPTH) {
+        error(expansion, file, name->start, "Includes are nested too deeply.");
+        return;
+    }
+    if (std::find(expansion->stack.begin(), expansion->stack.end(), path) !=
+        expansion->stack.end()) {
+        error(expansion, file, name->start, "File \"%s\" includes itself.",
+              path.c_str());
+        return;
+    }
+    std::shared_ptr<const IncludedFile> included =
+        expansion->cache->get(path);
+    bool seen = std::any_of(expanded->dependencies.begin(),
+                            expanded->dependencies.end(),
+                            [&](const Dependency &dependency) {
+                                return dependency.path == path;
+                            });
+    if (included == nullptr) {
+        // listed all the same, so a cached failure goes stale once the
+        // file turns up
+        if (!seen)
+            expanded->dependencies.push_back({path, UNREADABLE_HASH});
+        error(expansion, file, name->start, "Could not read file \"%s\".",
+              path.c_str());
+        return;
+    }
+
+    if (!seen) {
+        expanded->dependencies.push_back({path, included->hash});
+    }
+    if (included->hadError) {
+        // reported once however often the file is included
+        if (!seen)
+            expansion->diagnostics->append(included->diagnostics);
+        expansion->hadError = true;
+        return;
+    }
+
+    expanded->files.push_back(included);
+    int child = expanded->map.addFile(path, included->text.data(),
+                                      included->text.size());
+    expansion->stack.push_back(path);
+    splice(expansion, child, path, included->text.data(),
+           included->text.size(), included->tokens.data(),
+           included->tokens.size());
+    expansion->stack.pop_back();
+}
+
+// Copies the text of a file into the expanded source segment by segment,
+// cutting after each include directive to splice in the included file. The
+// directive's tokens are dropped, its newline still ends the statement.
+static void splice(Expansion *expansion, int file, const std::string &path,
+                   const char *text, size_t length, const Token *tokens,
+                   size_t count) {
+    ExpandedSource *expanded = expansion->expanded;
+    std::string directory = directoryOf(path);
+    uint32_t segmentStart = 0;
+    size_t base = expanded->text.size();
+    expanded->map.addSegment(base, file, 0);
+
+    for (size_t i = 0; i < count; i++) {
+        if (!isDirective(text, tokens, i, count, "include")) {
+            Token token = tokens[i];
+            token.start = base + (token.start - segmentStart);
+            expanded->tokens.push_back(token);
+            continue;
+        }
+        if (i + 2 >= count || tokens[i + 2].type != TOKEN_STRING) {
+            error(expansion, file, tokens[i + 1].start,
+                  "Expected a file name after '.include'.");
+            i++;
+            continue;
+        }
+
+        const Token *name = &tokens[i + 2];
+        uint32_t cut = name->start + name->length;
+        expanded->text.append(text + segmentStart, cut - segmentStart);
+        // without the quotes, absolute paths are taken as they are
+        std::string target(text + name->start + 1, name->length - 2);
+        if (target.empty() || target[0] != '/')
+            target = directory + target;
+        include(expansion, file, name, target);
+
+        segmentStart = cut;
+        base = expanded->text.size();
+        expanded->map.addSegment(base, file, cut);
+        i += 2;
+    }
+    expanded->text.append(text + segmentStart, length - segmentStart);
+}
+
+bool expandIncludes(const char *path, const char *source, size_t length,
+                    const TokenList &tokens, IncludeCache *cache,
+                    ExpandedSource *expanded, Diagnostics *diagnostics) {
+    Expansion expansion = {cache, expanded, diagnostics, {}, false};
+    std::string main = strcmp(path, "-") == 0 ? "" : path;
+    expanded->tokens.reserve(tokens.size());
+    int file = expanded->map.addFile("", source, length);
+    expansion.stack.push_back(main);
+    splice(&expansion, file, main, source, length, tokens.data(),
+           tokens.size());
+
+    if (!expansion.hadError && expanded->text.size() > MAX_SOURCE_LENGTH) {
+        diagnostics->add(1, "Source is too large with its includes.");
+        expansion.hadError = true;
+    }
+    return !expansion.hadError;
+}
+
+// spaces, '#' and '$' would otherwise end or change a make word
+static void writeWord(FILE *file, const std::string &word) {
+    for (char c : word) {
+        if (c == ' ' || c == '#')
+            fputc('\\', file);
+        else if (c == '$')
+            fputc('$', file);
+        fputc(c, file);
+    }
+}
+
+bool writeDepfile(const char *depfile, const char *target, const char *source,
+                  const std::vector<Dependency> &dependencies) {
+    FILE *file = fopen(depfile, "w");
+    if (file == nullptr)
+        return false;
+    writeWord(file, target);
+    fputs(":", file);
+    if (strcmp(source, "-") != 0) {
+        fputc(' ', file);
+        writeWord(file, source);
+    }
+    for (const Dependency &dependency : dependencies) {
+        fputs(" \\\n  ", file);
+        writeWord(file, dependency.path);
+    }
+    fputc('\n', file);
+    bool ok = !ferror(file);
+    return fclose(file) == 0 && ok;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <sys/types.h>
+#include <time.h>
+#include <unordered_map>
+#include <vector>
+
+#include "arena.h"
+#include "diagnostics.h"
+#include "lines.h"
+#include "token.h"
+
+// nesting deeper than this is taken for a runaway include
+#define MAX_INCLUDE_DEPTH 64
+
+// A file that went into an assembly besides the source, for depfiles and
+// for telling whether a cached assembly is still current.
+typedef struct {
+    std::string path;
+    uint64_t hash; // XXH64 of its contents, or UNREADABLE_HASH
+} Dependency;
+
+// the hash of a file that could not be read, it never matches one that can
+#define UNREADABLE_HASH 0
+
+// A file pulled in by .include, scanned once. Its tokens are offsets into
+// text and carry no symbols, each including unit interns them itself, so
+// any number of units on any number of threads may share one.
+class IncludedFile {
+  public:
+    IncludedFile(const std::string &path, const char *data, size_t length);
+    IncludedFile(const IncludedFile &) = delete;
+    IncludedFile &operator=(const IncludedFile &) = delete;
+
+    std::string path;
+    std::string text;
+    uint64_t hash;
+    Arena arena;
+    TokenList tokens;
+    Diagnostics diagnostics; // from scanning, already naming the file
+    bool hadError;
+};
+
+// Included files by path, shared by everything assembled in one process.
+// An entry is reused as long as the file keeps its modification time and
+// size, or failing that, its hash.
+class IncludeCache {
+  public:
+    // nullptr when the file can not be read
+    std::shared_ptr<const IncludedFile> get(const std::string &path);
+
+  private:
+    typedef struct {
+        std::shared_ptr<const IncludedFile> file;
+        struct timespec modified;
+        off_t size;
+    } Entry;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+};
+
+// Maps offsets in an expanded source back to the file and line they came
+// from, for diagnostics. File 0 is the source itself and has no name.
+class SourceMap {
+  public:
+    int addFile(const std::string &name, const char *text, size_t length);
+    void addSegment(uint32_t start, int file, uint32_t fileStart);
+    // both return the line, name points into the map
+    int lineIn(int file, uint32_t fileOffset, const char **name);
+    int locate(uint32_t offset, const char **name);
+
+  private:
+    typedef struct {
+        uint32_t start; // offset in the expanded source
+        int file;
+        uint32_t fileStart;
+    } Segment;
+
+    // lines are looked up by the compiler threads
+    std::mutex mutex;
+    std::vector<std::string> names;
+    std::vector<std::unique_ptr<LineIndex>> lines;
+    std::vector<Segment> segments;
+};
+
+// A source with the text and tokens of everything it includes spliced in
+// place of the directives, so the compiler sees a single source whose
+// offsets grow in token order.
+class ExpandedSource {
+  public:
+    ExpandedSource(Arena *arena) : tokens(arena) {}
+
+    std::string text;
+    TokenList tokens;
+    SourceMap map;
+    std::vector<Dependency> dependencies;
+    // keeps the texts alive for as long as the map needs them
+    std::vector<std::shared_ptr<const IncludedFile>> files;
+};
+
+// true when the tokens of source contain an .include directive, the only
+// one expandIncludes() has to handle
+bool hasIncludes(const char *source, const TokenList &tokens);
+
+// Splices in every `.include "file"` of the source at path, looking files
+// up relative to the directory of the one that includes them. Returns false
+// when a file can not be read, includes itself, or fails to scan.
+bool expandIncludes(const char *path, const char *source, size_t length,
+                    const TokenList &tokens, IncludeCache *cache,
+                    ExpandedSource *expanded, Diagnostics *diagnostics);
+
+// Writes a make rule "target: source dependencies..." to depfile
+bool writeDepfile(const char *depfile, const char *target, const char *source,
+                  const std::vector<Dependency> &dependencies);
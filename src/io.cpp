@@ -0,0 +1,131 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "io.h"
+
+// streams have no size up front, the buffer doubles as it fills up
+static bool readStream(int fd, SourceFile *source) {
+    size_t capacity = 64 * 1024;
+    size_t length = 0;
+    char *data = (char *)malloc(capacity);
+    if (data == nullptr)
+        return false;
+
+    while (true) {
+        if (length == capacity) {
+            capacity *= 2;
+            char *grown = (char *)realloc(data, capacity);
+            if (grown == nullptr) {
+                free(data);
+                return false;
+            }
+            data = grown;
+        }
+        ssize_t count = read(fd, data + length, capacity - length);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            free(data);
+            return false;
+        }
+        if (count == 0)
+            break;
+        length += count;
+    }
+
+    source->data = data;
+    source->length = length;
+    source->allocated = true;
+    return true;
+}
+
+bool openSource(const char *path, SourceFile *source) {
+    source->data = nullptr;
+    source->length = 0;
+    source->mapped = false;
+    source->allocated = false;
+
+    if (strcmp(path, "-") == 0)
+        return readStream(STDIN_FILENO, source);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return false;
+    }
+
+    // pipes, fifos and devices can not be mapped
+    if (!S_ISREG(st.st_mode)) {
+        bool read = readStream(fd, source);
+        close(fd);
+        return read;
+    }
+
+    // mmap rejects empty mappings, an empty file is simply an empty source
+    if (st.st_size == 0) {
+        close(fd);
+        source->data = "";
+        return true;
+    }
+
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    source->data = (const char *)data;
+    source->length = st.st_size;
+    source->mapped = true;
+    return true;
+}
+
+void closeSource(SourceFile *source) {
+    if (source->mapped) {
+        munmap((void *)source->data, source->length);
+    } else if (source->allocated) {
+        free((void *)source->data);
+    }
+    source->data = nullptr;
+    source->length = 0;
+    source->mapped = false;
+    source->allocated = false;
+}
+
+static bool writeAll(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += written;
+        length -= written;
+    }
+    return true;
+}
+
+bool writeRom(const char *path, const char *data, size_t length) {
+    if (strcmp(path, "-") == 0)
+        return writeAll(STDOUT_FILENO, data, length);
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+
+    if (!writeAll(fd, data, length)) {
+        close(fd);
+        return false;
+    }
+    return close(fd) == 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stddef.h>
+
+// A read-only view of an input file. Regular files are memory-mapped, so the
+// scanner works directly on the page cache without a private copy. Pipes and
+// other streams are read into a growing heap buffer instead.
+typedef struct {
+    const char *data;
+    size_t length;
+    bool mapped;
+    bool allocated;
+} SourceFile;
+
+// "-" reads standard input
+bool openSource(const char *path, SourceFile *source);
+void closeSource(SourceFile *source);
+
+// Writes the whole ROM with as few write(2) calls as the kernel allows, "-"
+// writes it to standard output.
+bool writeRom(const char *path, const char *data, size_t length);
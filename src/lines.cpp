@@ -0,0 +1,32 @@
+#include <algorithm>
+#include <string.h>
+
+#include "lines.h"
+
+LineIndex::LineIndex(const char *source, size_t length) {
+    this->source = source;
+    this->length = length;
+    this->built = false;
+}
+
+void LineIndex::build() {
+    const char *current = source;
+    const char *end = source + length;
+    while (current < end) {
+        const char *newline =
+            (const char *)memchr(current, '\n', end - current);
+        if (newline == nullptr)
+            break;
+        newlines.push_back(newline - source);
+        current = newline + 1;
+    }
+    built = true;
+}
+
+// the line of an offset is one more than the number of newlines before it
+int LineIndex::lineOf(uint32_t offset) {
+    if (!built)
+        build();
+    return std::lower_bound(newlines.begin(), newlines.end(), offset) -
+           newlines.begin() + 1;
+}
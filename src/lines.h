@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Maps source offsets back to line numbers. Tokens do not store their line,
+// the index of newline offsets is only built once a diagnostic needs it.
+class LineIndex {
+  public:
+    LineIndex(const char *source, size_t length);
+    int lineOf(uint32_t offset);
+
+  private:
+    const char *source;
+    size_t length;
+    bool built;
+    std::vector<uint32_t> newlines;
+
+    void build();
+};
@@ -1,69 +1,373 @@
+#include <errno.h>
+#include <limits.h>
+#include <memory>
+#include <new>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
 
-#include "compiler.h"
-#include "scanner.h"
-#include "token.h"
+#include "assembler.h"
+#include "batch.h"
+#include "cache.h"
+#include "diagnostics.h"
+#include "include.h"
+#include "io.h"
+#include "object.h"
+#include "server.h"
+#include "stats.h"
+#include "watch.h"
 
-int main(int argc, char *argv[]) {
-    if (argc < 2 || argc > 3) {
-        fprintf(stderr, "Usage: ch8asm [file to assemble] (outfile)\n");
-        exit(64);
-    }
+// Replaced so --stats can count heap allocations, see stats.h. The default
+// array forms end up here. The aligned ones call aligned_alloc() directly in
+// libstdc++, so they are replaced as well. The deletes are not inlined,
+// which would have GCC take free() after operator new for a mismatch.
+void *operator new(size_t size) {
+    countAllocation(size);
+    void *pointer = malloc(size > 0 ? size : 1);
+    if (pointer == nullptr)
+        throw std::bad_alloc();
+    return pointer;
+}
 
-    FILE *file = fopen(argv[1], "rb");
-    if (file == NULL) {
-        fprintf(stderr, "Could not open file \"%s\"", argv[1]);
-        exit(74);
-    }
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    countAllocation(size);
+    return malloc(size > 0 ? size : 1);
+}
 
-    fseek(file, 0L, SEEK_END);
-    size_t fileSize = ftell(file);
-    rewind(file);
+// aligned_alloc() takes whole multiples of the alignment only
+static void *alignedAllocate(size_t size, std::align_val_t align) {
+    size_t alignment = (size_t)align;
+    countAllocation(size);
+    return aligned_alloc(alignment, size > 0 ? (size + alignment - 1) &
+                                                   ~(alignment - 1)
+                                             : alignment);
+}
 
-    char *buffer = (char *)malloc(fileSize + 1);
-    if (buffer == NULL) {
-        fprintf(stderr, "Not enough memory to read \"%s\".\n", argv[1]);
-        exit(74);
+void *operator new(size_t size, std::align_val_t align) {
+    void *pointer = alignedAllocate(size, align);
+    if (pointer == nullptr)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new(size_t size, std::align_val_t align,
+                   const std::nothrow_t &) noexcept {
+    return alignedAllocate(size, align);
+}
+
+__attribute__((noinline)) void operator delete(void *pointer) noexcept {
+    free(pointer);
+}
+
+__attribute__((noinline)) void operator delete(void *pointer,
+                                               size_t) noexcept {
+    free(pointer);
+}
+
+__attribute__((noinline)) void
+operator delete(void *pointer, const std::nothrow_t &) noexcept {
+    free(pointer);
+}
+
+__attribute__((noinline)) void operator delete(void *pointer,
+                                               std::align_val_t) noexcept {
+    free(pointer);
+}
+
+__attribute__((noinline)) void
+operator delete(void *pointer, size_t, std::align_val_t) noexcept {
+    free(pointer);
+}
+
+__attribute__((noinline)) void
+operator delete(void *pointer, std::align_val_t,
+                const std::nothrow_t &) noexcept {
+    free(pointer);
+}
+
+static void flushCache(AssemblyCache *cache, bool verbose) {
+    CacheStats stats;
+    if (cache == nullptr)
+        return;
+    if (!cache->flush(&stats)) {
+        fprintf(stderr, "Could not update the cache statistics.\n");
+    } else if (verbose) {
+        fprintf(stderr, "cache: %llu hits, %llu misses, %llu bytes\n",
+                (unsigned long long)stats.hits,
+                (unsigned long long)stats.misses,
+                (unsigned long long)stats.bytes);
     }
-    size_t bytesRead = fread(buffer, sizeof(char), fileSize, file);
-    if (bytesRead < fileSize) {
-        fprintf(stderr, "Could not read file \"%s\".\n", argv[1]);
-        exit(74);
+}
+
+// reports the errors or writes the ROM or object and its depfile, returns
+// the exit code
+static int finish(AssembleStatus status, Diagnostics &diagnostics,
+                  const char *infile, const char *outfile, const char *data,
+                  size_t length, const char *depfile,
+                  const std::vector<Dependency> &dependencies,
+                  Stats *stats) {
+    if (status == ASSEMBLE_SOURCE_TOO_LARGE) {
+        fprintf(stderr, "File \"%s\" is too large.\n", infile);
+        return 74;
+    }
+    if (status != ASSEMBLE_OK) {
+        diagnostics.print(stderr);
+        fprintf(stderr, status == ASSEMBLE_SCAN_ERROR ? "Scanning failed.\n"
+                                                      : "Compiling failed.\n");
+        return 65;
     }
-    buffer[bytesRead] = '\0';
-    fclose(file);
+    PhaseTimer timer(stats, PHASE_WRITE);
+    if (!writeRom(outfile, data, length)) {
+        fprintf(stderr, "Could not write file \"%s\".\n", outfile);
+        return 74;
+    }
+    if (depfile != nullptr &&
+        !writeDepfile(depfile, outfile, infile, dependencies)) {
+        fprintf(stderr, "Could not write file \"%s\".\n", depfile);
+        return 74;
+    }
+    return 0;
+}
+
+static void usage() {
+    fprintf(stderr,
+            "Usage: ch8asm [-v] [-j threads] [--pipeline] [--cache dir] "
+            "[--cache-size MiB]\n"
+            "              [--stats[=json]] [-MD] [-MF depfile] "
+            "[file to assemble] (outfile)\n"
+            "       ch8asm -c [--stats[=json]] [-MD] [-MF depfile] "
+            "[module to assemble] (object)\n"
+            "       ch8asm [-v] [-j threads] [--pipeline] [--cache dir] [-c] "
+            "[-MD] --batch\n"
+            "              [files or @manifest...]\n"
+            "       ch8asm [-j threads] --serve [socket]\n"
+            "       ch8asm --connect [socket] [file to assemble] (outfile)\n"
+            "       ch8asm --watch [file to assemble] (outfile)\n");
+    exit(64);
+}
+
+// a positive count, anything else is a usage error
+static int parseThreads(const char *text) {
+    char *end;
+    errno = 0;
+    long threads = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || threads < 1 ||
+        threads > INT_MAX)
+        usage();
+    return threads;
+}
+
+// MiB that still fit a byte count, anything else is a usage error. Only
+// digits, strtoull() would skip spaces and wrap a minus sign around.
+static uint64_t parseCacheSize(const char *text) {
+    char *end;
+    errno = 0;
+    unsigned long long size = strtoull(text, &end, 10);
+    if (text[0] < '0' || text[0] > '9' || *end != '\0' || errno == ERANGE ||
+        size > SIZE_MAX >> 20)
+        usage();
+    return size;
+}
 
-    std::vector<Token> tokens;
-    Scanner scanner(buffer);
-    scanner.scan(&tokens);
+// after everything else for the file, the heap is counted until now
+static void printStats(Stats *stats, bool json, const char *infile) {
+    stats->allocations = allocationCount.load();
+    stats->allocatedBytes = allocationBytes.load();
+    if (json)
+        stats->printJson(stderr, infile);
+    else
+        stats->print(stderr, infile);
+}
 
-    if (scanner.hadError) {
-        fprintf(stderr, "Scanning failed.\n");
-        exit(65);
+int main(int argc, char *argv[]) {
+    bool verbose = false;
+    bool pipeline = false;
+    bool batch = false;
+    bool watching = false;
+    const char *serveSocket = nullptr;
+    const char *connectSocket = nullptr;
+    const char *cacheDirectory = nullptr;
+    bool depfile = false;
+    bool objects = false;
+    bool showStats = false;
+    bool statsJson = false;
+    const char *depfilePath = nullptr;
+    uint64_t cacheSize = 64;
+    int threads = std::thread::hardware_concurrency();
+    int arg = 1;
+    // a lone "-" is standard input or output, not an option
+    while (arg < argc && argv[arg][0] == '-' && argv[arg][1] != '\0') {
+        if (strcmp(argv[arg], "-v") == 0) {
+            verbose = true;
+        } else if (strcmp(argv[arg], "--pipeline") == 0) {
+            pipeline = true;
+        } else if (strcmp(argv[arg], "--batch") == 0) {
+            batch = true;
+        } else if (strcmp(argv[arg], "-c") == 0) {
+            objects = true;
+        } else if (strcmp(argv[arg], "--stats") == 0) {
+            showStats = true;
+        } else if (strcmp(argv[arg], "--stats=json") == 0) {
+            showStats = true;
+            statsJson = true;
+        } else if (strcmp(argv[arg], "-MD") == 0) {
+            depfile = true;
+        } else if (strcmp(argv[arg], "-MF") == 0 && arg + 1 < argc) {
+            depfile = true;
+            depfilePath = argv[++arg];
+        } else if (strcmp(argv[arg], "--watch") == 0) {
+            watching = true;
+        } else if (strcmp(argv[arg], "--serve") == 0 && arg + 1 < argc) {
+            serveSocket = argv[++arg];
+        } else if (strcmp(argv[arg], "--connect") == 0 && arg + 1 < argc) {
+            connectSocket = argv[++arg];
+        } else if (strcmp(argv[arg], "--cache") == 0 && arg + 1 < argc) {
+            cacheDirectory = argv[++arg];
+        } else if (strcmp(argv[arg], "--cache-size") == 0 && arg + 1 < argc) {
+            cacheSize = parseCacheSize(argv[++arg]);
+        } else if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc) {
+            threads = parseThreads(argv[++arg]);
+        } else {
+            usage();
+        }
+        arg++;
+    }
+    if (serveSocket != nullptr) {
+        serve(serveSocket, threads);
+        fprintf(stderr, "Could not serve on \"%s\".\n", serveSocket);
+        exit(71);
+    }
+    std::unique_ptr<AssemblyCache> cache;
+    if (cacheDirectory != nullptr) {
+        cache = std::make_unique<AssemblyCache>(cacheDirectory,
+                                                cacheSize << 20);
     }
 
-    char compileBuffer[4096 - 512 + 1];
-    Compiler compiler(&tokens, compileBuffer, 4096 - 512 + 1);
-    int blen = compiler.compile();
+    if (batch) {
+        const char *extension = objects ? ".o" : ".bin";
+        std::vector<BatchJob> jobs;
+        for (; arg < argc; arg++) {
+            if (argv[arg][0] != '@') {
+                jobs.push_back(batchJob(argv[arg], extension));
+            } else if (!readManifest(argv[arg] + 1, &jobs, extension)) {
+                fprintf(stderr, "Could not read file \"%s\".\n",
+                        argv[arg] + 1);
+                exit(74);
+            }
+        }
+        int code = runBatch(jobs, threads, cache.get(),
+                            {depfile, objects, pipeline, verbose, stderr});
+        flushCache(cache.get(), verbose);
+        exit(code);
+    }
+    if (argc - arg < 1 || argc - arg > 2) {
+        usage();
+    }
+    const char *infile = argv[arg];
+    const char *outfile = argc - arg == 2 ? argv[arg + 1]
+                          : objects       ? "out.o"
+                                          : "out.bin";
+    // like cc -MD, the rules go next to the output unless -MF says where
+    std::string depfileName;
+    if (depfile && depfilePath == nullptr) {
+        if (strcmp(outfile, "-") == 0)
+            usage();
+        depfileName = std::string(outfile) + ".d";
+        depfilePath = depfileName.c_str();
+    }
 
-    if (compiler.hadError) {
-        fprintf(stderr, "Compiling failed.\n");
-        exit(65);
+    if (watching) {
+        watch(infile, outfile);
+        fprintf(stderr, "Could not watch file \"%s\".\n", infile);
+        exit(74);
     }
 
-    const char *outfile = "out.bin";
-    if (argc == 3) {
-        outfile = argv[2];
+    // one file at a time, batches and servers would mix up their numbers
+    Stats stats;
+    Stats *collected = showStats ? &stats : nullptr;
+    allocationCounting = showStats;
+    SourceFile source;
+    bool read;
+    {
+        PhaseTimer timer(collected, PHASE_READ);
+        read = openSource(infile, &source);
+    }
+    if (!read) {
+        fprintf(stderr, "Could not read file \"%s\".\n", infile);
+        exit(74);
     }
+    stats.sourceBytes = source.length;
 
-    FILE *outFile = fopen(outfile, "wb");
-    int pos = 0;
-    blen++;
-    while (compileBuffer[pos] != EOF) {
-        fwrite(compileBuffer + pos, 1, 1, outFile);
-        pos++;
+    Assembler assembler(threads);
+    assembler.pipeline = pipeline;
+    assembler.path = infile;
+    assembler.stats = collected;
+    if (objects) {
+        // modules are small, the cache and server only deal in ROMs
+        ObjectFile object;
+        Diagnostics diagnostics;
+        AssembleStatus status = assembler.assembleObject(
+            source.data, source.length, &object, &diagnostics);
+        std::vector<char> bytes;
+        encodeObject(object, &bytes);
+        int code = finish(status, diagnostics, infile, outfile, bytes.data(),
+                          bytes.size(), depfilePath, assembler.dependencies,
+                          collected);
+        closeSource(&source);
+        if (showStats)
+            printStats(&stats, statsJson, infile);
+        exit(code);
+    }
+    Output output;
+    Diagnostics diagnostics;
+    AssembleStatus status;
+    std::vector<Dependency> dependencies;
+    if (cache != nullptr &&
+        cache->lookup(infile, source.data, source.length, &status, &output,
+                      &diagnostics, &dependencies)) {
+        // served from the cache
+    } else {
+        if (connectSocket != nullptr) {
+            int fd = connectServer(connectSocket);
+            RemoteStatus remote =
+                fd < 0 ? REMOTE_UNREACHABLE
+                       : remoteAssemble(fd, infile, source.data,
+                                        source.length, &output, &diagnostics,
+                                        &dependencies, &status);
+            if (remote == REMOTE_UNREACHABLE) {
+                fprintf(stderr, "Could not reach server \"%s\".\n",
+                        connectSocket);
+                exit(69);
+            } else if (remote == REMOTE_BAD_RESPONSE) {
+                fprintf(stderr, "Could not read the response of server "
+                                "\"%s\".\n",
+                        connectSocket);
+                exit(76);
+            }
+            close(fd);
+        } else {
+            status = assembler.assemble(source.data, source.length, &output,
+                                        &diagnostics);
+            dependencies = assembler.dependencies;
+        }
+        if (cache != nullptr) {
+            cache->store(infile, source.data, source.length, status, output,
+                         diagnostics, dependencies);
+        }
     }
+    flushCache(cache.get(), verbose);
 
-    exit(0);
+    if (verbose && status == ASSEMBLE_OK) {
+        fprintf(stderr, "%s: peak arena usage %zu bytes (%zu reserved)\n",
+                infile, assembler.arena.peak(), assembler.arena.reserved());
+    }
+    int code = finish(status, diagnostics, infile, outfile, output.data,
+                      output.length, depfilePath, dependencies, collected);
+    closeSource(&source);
+    if (showStats)
+        printStats(&stats, statsJson, infile);
+    exit(code);
 }
@@ -0,0 +1,104 @@
+#include <stdint.h>
+
+#include "mnemonic.h"
+#include "token.h"
+
+// Mnemonics are at most 4 characters long, so they are packed into a 32 bit
+// key (first character in the lowest byte, unused bytes zero). The
+// multiplicative hash below sends every mnemonic to its own slot, which is
+// checked at compile time, so a lookup is one probe and one compare.
+#define MNEMONIC_MAX_LENGTH 4
+#define MNEMONIC_HASH_BITS 6
+#define MNEMONIC_HASH_MULTIPLIER 840059u
+
+typedef struct {
+    const char *name;
+    TokenType type;
+} Mnemonic;
+
+typedef struct {
+    uint32_t key;
+    TokenType type;
+} MnemonicSlot;
+
+typedef struct {
+    MnemonicSlot slots[1 << MNEMONIC_HASH_BITS];
+    bool perfect;
+} MnemonicTable;
+
+static constexpr Mnemonic mnemonics[] = {
+    {"CLS", TOKEN_INST_CLS},   {"RET", TOKEN_INST_RET},
+    {"JP", TOKEN_INST_JP},     {"JPO", TOKEN_INST_JPO},
+    {"CALL", TOKEN_INST_CALL}, {"SE", TOKEN_INST_SE},
+    {"SNE", TOKEN_INST_SNE},   {"LD", TOKEN_INST_LD},
+    {"ADD", TOKEN_INST_ADD},   {"AND", TOKEN_INST_AND},
+    {"OR", TOKEN_INST_OR},     {"XOR", TOKEN_INST_XOR},
+    {"SUB", TOKEN_INST_SUB},   {"SHR", TOKEN_INST_SHR},
+    {"SUBN", TOKEN_INST_SUBN}, {"SHL", TOKEN_INST_SHL},
+    {"RND", TOKEN_INST_RND},   {"DRW", TOKEN_INST_DRW},
+    {"SKP", TOKEN_INST_SKP},   {"SKNP", TOKEN_INST_SKNP},
+    {"GDT", TOKEN_INST_GDT},   {"WKP", TOKEN_INST_WKP},
+    {"SDT", TOKEN_INST_SDT},   {"SST", TOKEN_INST_SST},
+    {"FNT", TOKEN_INST_FNT},   {"BCD", TOKEN_INST_BCD},
+    {"STV", TOKEN_INST_STV},   {"LDV", TOKEN_INST_LDV},
+};
+
+static constexpr uint32_t packMnemonic(const char *start, int length) {
+    uint32_t key = 0;
+    for (int i = 0; i < length; i++) {
+        key |= (uint32_t)(uint8_t)start[i] << (i * 8);
+    }
+    return key;
+}
+
+static constexpr uint32_t hashMnemonic(uint32_t key) {
+    return (uint32_t)(key * MNEMONIC_HASH_MULTIPLIER) >>
+           (32 - MNEMONIC_HASH_BITS);
+}
+
+static constexpr int nameLength(const char *name) {
+    int length = 0;
+    while (name[length] != '\0')
+        length++;
+    return length;
+}
+
+static constexpr MnemonicTable buildMnemonicTable() {
+    MnemonicTable table = {};
+    for (auto &slot : table.slots) {
+        slot.type = TOKEN_IDENTIFIER;
+    }
+    table.perfect = true;
+
+    for (const Mnemonic &mnemonic : mnemonics) {
+        uint32_t key = packMnemonic(mnemonic.name, nameLength(mnemonic.name));
+        MnemonicSlot &slot = table.slots[hashMnemonic(key)];
+        if (slot.key != 0) {
+            table.perfect = false;
+        }
+        slot.key = key;
+        slot.type = mnemonic.type;
+    }
+    return table;
+}
+
+static constexpr MnemonicTable mnemonicTable = buildMnemonicTable();
+static_assert(mnemonicTable.perfect,
+              "mnemonic hash has collisions, pick another multiplier");
+
+TokenType lookupInstruction(const char *start, int length) {
+    if (length > MNEMONIC_MAX_LENGTH)
+        return TOKEN_IDENTIFIER;
+
+    uint32_t key = packMnemonic(start, length);
+    const MnemonicSlot &slot = mnemonicTable.slots[hashMnemonic(key)];
+    return slot.key == key ? slot.type : TOKEN_IDENTIFIER;
+}
+
+const char *mnemonicName(TokenType type) {
+    for (const Mnemonic &mnemonic : mnemonics) {
+        if (mnemonic.type == type)
+            return mnemonic.name;
+    }
+    return "";
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "token.h"
+
+// Returns the instruction token type for a mnemonic or TOKEN_IDENTIFIER if
+// the given text is not one.
+TokenType lookupInstruction(const char *start, int length);
+
+// the mnemonic of an instruction token type, e.g. "JPO" for TOKEN_INST_JPO
+const char *mnemonicName(TokenType type);
@@ -0,0 +1,182 @@
+#include <string.h>
+#include <unordered_map>
+
+#include "assembler.h"
+#include "bytes.h"
+#include "object.h"
+
+void ObjectFile::clear() {
+    code.clear();
+    files.clear();
+    exports.clear();
+    imports.clear();
+    relocations.clear();
+}
+
+static void putLocation(std::vector<char> *bytes,
+                        const ObjectLocation &location) {
+    putU32(bytes, location.file);
+    putU32(bytes, location.line);
+}
+
+void encodeObject(const ObjectFile &object, std::vector<char> *bytes) {
+    bytes->insert(bytes->end(), OBJECT_MAGIC, OBJECT_MAGIC + 4);
+    putU32(bytes, OBJECT_VERSION);
+    putU32(bytes, object.code.size());
+    bytes->insert(bytes->end(), object.code.begin(), object.code.end());
+    putU32(bytes, object.files.size());
+    for (const std::string &file : object.files) {
+        putString(bytes, file);
+    }
+    putU32(bytes, object.exports.size());
+    for (const ObjectExport &symbol : object.exports) {
+        putString(bytes, symbol.name);
+        putU32(bytes, symbol.offset);
+        putLocation(bytes, symbol.location);
+    }
+    putU32(bytes, object.imports.size());
+    for (const std::string &name : object.imports) {
+        putString(bytes, name);
+    }
+    putU32(bytes, object.relocations.size());
+    for (const Relocation &relocation : object.relocations) {
+        putU32(bytes, relocation.offset);
+        putU32(bytes, relocation.import);
+        putLocation(bytes, relocation.location);
+    }
+}
+
+static bool getLocation(Reader *reader, const ObjectFile &object,
+                        ObjectLocation *location) {
+    return getU32(reader, &location->file) &&
+           getU32(reader, &location->line) &&
+           location->file < object.files.size();
+}
+
+bool decodeObject(const char *bytes, size_t length, ObjectFile *object) {
+    Reader reader = {(const uint8_t *)bytes, (const uint8_t *)bytes + length};
+    char magic[4];
+    uint32_t version, count, value;
+    object->clear();
+    if (!getBytes(&reader, magic, 4) || memcmp(magic, OBJECT_MAGIC, 4) != 0 ||
+        !getU32(&reader, &version) || version != OBJECT_VERSION ||
+        !getU32(&reader, &count) || count > MAX_ROM_LENGTH)
+        return false;
+    object->code.resize(count);
+    if (!getBytes(&reader, object->code.data(), count))
+        return false;
+
+    if (!getU32(&reader, &count))
+        return false;
+    object->files.resize(count);
+    for (std::string &file : object->files) {
+        if (!getString(&reader, &file))
+            return false;
+    }
+
+    if (!getU32(&reader, &count))
+        return false;
+    for (uint32_t i = 0; i < count; i++) {
+        ObjectExport symbol;
+        if (!getString(&reader, &symbol.name) || !getU32(&reader, &value) ||
+            value > object->code.size() ||
+            !getLocation(&reader, *object, &symbol.location))
+            return false;
+        symbol.offset = value;
+        object->exports.push_back(symbol);
+    }
+
+    if (!getU32(&reader, &count))
+        return false;
+    object->imports.resize(count);
+    for (std::string &name : object->imports) {
+        if (!getString(&reader, &name))
+            return false;
+    }
+
+    if (!getU32(&reader, &count))
+        return false;
+    for (uint32_t i = 0; i < count; i++) {
+        Relocation relocation;
+        // value + 2 would wrap around for the largest offsets
+        if (!getU32(&reader, &value) || value >= object->code.size() ||
+            object->code.size() - value < 2 ||
+            !getU32(&reader, &relocation.import) ||
+            (relocation.import != LOCAL_LABEL &&
+             relocation.import >= object->imports.size()) ||
+            !getLocation(&reader, *object, &relocation.location))
+            return false;
+        relocation.offset = value;
+        object->relocations.push_back(relocation);
+    }
+    return reader.at == reader.end;
+}
+
+typedef struct {
+    uint16_t address;
+    ObjectLocation location;
+} Placed;
+
+static void linkError(Diagnostics *diagnostics, const ObjectFile &module,
+                      const ObjectLocation &location, const char *format,
+                      const std::string &name) {
+    diagnostics->addIn(module.files[location.file].c_str(), location.line,
+                       format, name.c_str());
+}
+
+bool link(const std::vector<ObjectFile> &modules,
+          const std::vector<std::string> &names, std::vector<char> *rom,
+          Diagnostics *diagnostics) {
+    bool ok = true;
+    std::vector<uint16_t> bases;
+    rom->clear();
+    for (size_t m = 0; m < modules.size(); m++) {
+        bases.push_back(rom->size());
+        rom->insert(rom->end(), modules[m].code.begin(),
+                    modules[m].code.end());
+        if (rom->size() > MAX_ROM_LENGTH) {
+            diagnostics->addIn(names[m].c_str(), 0,
+                               "Linked program is too large.");
+            return false;
+        }
+    }
+
+    std::unordered_map<std::string, Placed> exported;
+    for (size_t m = 0; m < modules.size(); m++) {
+        for (const ObjectExport &symbol : modules[m].exports) {
+            Placed placed = {(uint16_t)(512 + bases[m] + symbol.offset),
+                             symbol.location};
+            if (!exported.emplace(symbol.name, placed).second) {
+                linkError(diagnostics, modules[m], symbol.location,
+                          "Label '%s' is exported more than once.",
+                          symbol.name);
+                ok = false;
+            }
+        }
+    }
+
+    for (size_t m = 0; m < modules.size(); m++) {
+        const ObjectFile &module = modules[m];
+        for (const Relocation &relocation : module.relocations) {
+            size_t at = bases[m] + relocation.offset;
+            uint16_t address =
+                ((uint8_t)(*rom)[at] & 0x0F) << 8 | (uint8_t)(*rom)[at + 1];
+            if (relocation.import == LOCAL_LABEL) {
+                address += bases[m];
+            } else {
+                const std::string &name = module.imports[relocation.import];
+                auto placed = exported.find(name);
+                if (placed == exported.end()) {
+                    linkError(diagnostics, module, relocation.location,
+                              "Label '%s' does not exist.", name);
+                    ok = false;
+                    continue;
+                }
+                address = placed->second.address;
+            }
+            (*rom)[at] = ((*rom)[at] & 0xF0) | ((address >> 8) & 0x0F);
+            (*rom)[at + 1] = (uint8_t)address;
+        }
+    }
+    return ok;
+}
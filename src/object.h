@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "diagnostics.h"
+
+#define OBJECT_MAGIC "CH8O"
+#define OBJECT_VERSION 1
+// relocations of labels defined in the module itself
+#define LOCAL_LABEL UINT32_MAX
+
+// where a symbol or reference was written, for the linker's diagnostics
+typedef struct {
+    uint32_t file; // index into ObjectFile::files
+    uint32_t line;
+} ObjectLocation;
+
+typedef struct {
+    std::string name;
+    uint16_t offset; // from the start of the module's code
+    ObjectLocation location;
+} ObjectExport;
+
+// The 12 bit address field of the instruction at offset. A local label's
+// address is already in the field, as if the module started at 0x200, an
+// imported one is filled in by the linker.
+typedef struct {
+    uint16_t offset;
+    uint32_t import; // index into ObjectFile::imports, or LOCAL_LABEL
+    ObjectLocation location;
+} Relocation;
+
+// A module assembled on its own (see Assembler::assembleObject). Labels
+// named by `.export` may be used by other modules, labels it uses but does
+// not define are imports. ch8link places modules one after the other and
+// patches the relocations.
+class ObjectFile {
+  public:
+    std::vector<char> code;
+    std::vector<std::string> files; // 0 is the module's source
+    std::vector<ObjectExport> exports;
+    std::vector<std::string> imports;
+    std::vector<Relocation> relocations;
+
+    void clear();
+};
+
+// The magic and version, then code, files, exports, imports and
+// relocations, each a count followed by the entries. Integers are 32 bit
+// little endian, strings are prefixed with their length.
+void encodeObject(const ObjectFile &object, std::vector<char> *bytes);
+// false when the bytes are not an object of this version
+bool decodeObject(const char *bytes, size_t length, ObjectFile *object);
+
+// Places the modules from 0x200 on in the given order, names are used in
+// diagnostics. Returns false if a label is missing or exported twice, or
+// the program does not fit.
+bool link(const std::vector<ObjectFile> &modules,
+          const std::vector<std::string> &names, std::vector<char> *rom,
+          Diagnostics *diagnostics);
@@ -0,0 +1,103 @@
+#include <memory>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "arena.h"
+#include "parallelscan.h"
+#include "scanner.h"
+
+typedef struct Chunk {
+    size_t begin;
+    size_t end;
+    Arena arena;
+    TokenList tokens;
+    SymbolTable symbols;
+    Diagnostics diagnostics;
+    bool hadError;
+
+    Chunk(size_t begin, size_t end)
+        : begin(begin), end(end), tokens(&arena), symbols(&arena),
+          hadError(false) {}
+} Chunk;
+
+static void scanChunk(const char *source, size_t length,
+                      const ScanKernels *kernels, Chunk *chunk) {
+    Scanner scanner(source, length, &chunk->symbols, &chunk->diagnostics,
+                    kernels);
+    scanner.setRange(chunk->begin, chunk->end);
+    scanner.scan(&chunk->tokens);
+    chunk->hadError = scanner.hadError;
+}
+
+// Every statement ends at a newline and comments do too, so a chunk boundary
+// right after a newline never splits a token.
+static std::vector<std::unique_ptr<Chunk>>
+splitChunks(const char *source, size_t length, int count) {
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    size_t begin = 0;
+    for (int i = 1; i <= count && begin < length; i++) {
+        size_t end = length;
+        if (i < count) {
+            size_t target = length / count * i;
+            if (target < begin)
+                target = begin;
+            const char *newline = (const char *)memchr(
+                source + target, '\n', length - target);
+            end = newline == nullptr ? length : newline - source + 1;
+        }
+        chunks.push_back(std::make_unique<Chunk>(begin, end));
+        begin = end;
+    }
+    return chunks;
+}
+
+bool scanSource(const char *source, size_t length, SymbolTable *symbols,
+                TokenList *tokens, Diagnostics *diagnostics, int threads,
+                const ScanKernels *kernels) {
+    if (threads <= 1 || length < PARALLEL_SCAN_THRESHOLD) {
+        Scanner scanner(source, length, symbols, diagnostics, kernels);
+        scanner.scan(tokens);
+        return !scanner.hadError;
+    }
+
+    std::vector<std::unique_ptr<Chunk>> chunks =
+        splitChunks(source, length, threads);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < chunks.size(); i++) {
+        workers.emplace_back(scanChunk, source, length, kernels,
+                             chunks[i].get());
+    }
+    scanChunk(source, length, kernels, chunks[0].get());
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    size_t total = 0;
+    for (auto &chunk : chunks) {
+        total += chunk->tokens.size();
+    }
+    tokens->reserve(tokens->size() + total);
+
+    // Interning the chunk-local names in chunk order hands out ids in the
+    // same first-seen order a single scanner would use.
+    bool ok = true;
+    std::vector<int> remap;
+    for (auto &chunk : chunks) {
+        remap.resize(chunk->symbols.count());
+        for (int id = 0; id < chunk->symbols.count(); id++) {
+            Symbol *symbol = chunk->symbols.get(id);
+            remap[id] =
+                symbols->intern(symbol->name.data(), symbol->name.size());
+        }
+
+        for (Token token : chunk->tokens) {
+            if (token.symbol != NO_SYMBOL)
+                token.symbol = remap[token.symbol];
+            tokens->push_back(token);
+        }
+        diagnostics->append(chunk->diagnostics);
+        ok = ok && !chunk->hadError;
+    }
+    return ok;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "diagnostics.h"
+#include "fastscan.h"
+#include "symbols.h"
+#include "token.h"
+
+// sources smaller than this are not worth the thread start up
+#define PARALLEL_SCAN_THRESHOLD (1 << 20)
+
+// Scans the source into tokens, splitting it at newlines into one chunk per
+// thread when it is large enough. The tokens, symbol ids and diagnostics are
+// the same as those of a single Scanner. Returns false on errors.
+bool scanSource(const char *source, size_t length, SymbolTable *symbols,
+                TokenList *tokens, Diagnostics *diagnostics, int threads,
+                const ScanKernels *kernels);
@@ -0,0 +1,46 @@
+#include <thread>
+
+#include "compiler.h"
+#include "pipeline.h"
+#include "scanner.h"
+#include "tokenring.h"
+
+// identifiers are left for the compiler to intern, the symbol table is not
+// safe to share between the threads
+static void produce(const char *source, size_t length,
+                    const ScanKernels *kernels, TokenRing *ring,
+                    Diagnostics *diagnostics, bool *hadError) {
+    Scanner scanner(source, length, nullptr, diagnostics, kernels);
+    Token token;
+    while (scanner.scanToken(&token)) {
+        ring->push(token);
+    }
+    ring->close();
+    *hadError = scanner.hadError;
+}
+
+PipelineStatus assemblePipelined(const char *source, size_t length,
+                                 SymbolTable *symbols, Arena *arena,
+                                 Diagnostics *diagnostics, char *buffer,
+                                 int bufferLength, int *written,
+                                 const ScanKernels *kernels) {
+    TokenRing ring(TOKEN_RING_CAPACITY);
+    Diagnostics scanDiagnostics;
+    Diagnostics compileDiagnostics;
+    bool scanError = false;
+    std::thread scanner(produce, source, length, kernels, &ring,
+                        &scanDiagnostics, &scanError);
+
+    TokenList line(arena);
+    Compiler compiler(&line, source, length, symbols, arena,
+                      &compileDiagnostics);
+    *written = compiler.compileStream(&ring, buffer, bufferLength);
+    scanner.join();
+
+    if (scanError) {
+        diagnostics->append(scanDiagnostics);
+        return PIPELINE_SCAN_ERROR;
+    }
+    diagnostics->append(compileDiagnostics);
+    return compiler.hadError ? PIPELINE_COMPILE_ERROR : PIPELINE_OK;
+}
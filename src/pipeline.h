@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "arena.h"
+#include "diagnostics.h"
+#include "fastscan.h"
+#include "symbols.h"
+
+// tokens in flight between the scanner and the compiler
+#define TOKEN_RING_CAPACITY 4096
+
+typedef enum {
+    PIPELINE_OK,
+    PIPELINE_SCAN_ERROR,
+    PIPELINE_COMPILE_ERROR,
+} PipelineStatus;
+
+// Scans on a second thread while the compiler consumes the tokens a line at a
+// time, so no more than the ring and the longest line are ever held instead
+// of the whole token list. The output and diagnostics match scanSource()
+// followed by Compiler::compile(): on a scan error only the scanner's
+// diagnostics are kept.
+PipelineStatus assemblePipelined(const char *source, size_t length,
+                                 SymbolTable *symbols, Arena *arena,
+                                 Diagnostics *diagnostics, char *buffer,
+                                 int bufferLength, int *written,
+                                 const ScanKernels *kernels);
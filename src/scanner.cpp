@@ -1,29 +1,47 @@
-#include <cstring>
-#include <stdio.h>
-
 #include "common.h"
+#include "fastscan.h"
+#include "mnemonic.h"
 #include "scanner.h"
 #include "token.h"
 
-void Scanner::error(int line, char c, const char *message) {
+void Scanner::error(char c, const char *message) {
     if (!panicMode) {
-        fprintf(stderr, "[line %d] '%c' %s\n", line, c, message);
+        diagnostics->add(lines.lineOf(this->start - this->source), "'%c' %s",
+                         c, message);
         panicMode = true;
     }
     hadError = true;
 }
 
-Scanner::Scanner(const char *source) {
+// identifiers are interned into symbols as they are scanned, pass nullptr to
+// leave that to the compiler. Without kernels the best the CPU supports are
+// used.
+Scanner::Scanner(const char *source, size_t length, SymbolTable *symbols,
+                 Diagnostics *diagnostics, const ScanKernels *kernels)
+    : lines(source, length) {
+    this->source = source;
     this->start = source;
     this->hadError = false;
     this->current = source;
-    this->line = 1;
+    this->end = source + length;
+    this->symbols = symbols;
+    this->diagnostics = diagnostics;
+    this->panicMode = false;
+    this->kernels =
+        kernels != nullptr ? kernels : scanKernels(detectScanBackend());
+}
+
+// limits scanning to [begin, end) of the source, offsets and lines in tokens
+// and errors still refer to the whole source
+void Scanner::setRange(size_t begin, size_t end) {
+    this->start = this->source + begin;
+    this->current = this->source + begin;
+    this->end = this->source + end;
 }
 
+// '\0' before the first character, like peek() after the last
 char Scanner::previous() {
-    // TODO - this can cause a segfault if current points at the start of the
-    //        string
-    return this->current[-1];
+    return this->current > this->source ? this->current[-1] : '\0';
 }
 
 char Scanner::advance() {
@@ -31,184 +49,62 @@ char Scanner::advance() {
     return this->current[-1];
 }
 
-char Scanner::peek() { return this->current[0]; }
+// the source is not necessarily NUL terminated (e.g. when it is mmapped), so
+// reads past the end yield '\0' instead of touching the buffer
+char Scanner::peek() { return isAtEnd() ? '\0' : this->current[0]; }
 
-char Scanner::peekNext() { return this->current[1]; }
+char Scanner::peekNext() {
+    return this->end - this->current < 2 ? '\0' : this->current[1];
+}
 
-bool Scanner::isAtEnd() { return this->current[0] == '\0'; }
+bool Scanner::isAtEnd() { return this->current >= this->end; }
 
 Token Scanner::newToken(TokenType type) {
     Token token;
     token.type = type;
-    token.start = this->start;
+    token.start = this->start - this->source;
     token.length = this->current - this->start;
-    token.line = this->line;
+    if (this->current - this->start > MAX_TOKEN_LENGTH) {
+        error(*this->start, "Token is too long.");
+    }
+    token.symbol = NO_SYMBOL;
     return token;
 }
 
 Token Scanner::literal() {
     if (*this->start == '%') {
-        while (isBinary(peek()))
-            advance();
+        this->current = kernels->skipBinary(this->current, this->end);
     } else if (*this->start == '$') {
-        while (isHex(peek()))
-            advance();
+        this->current = kernels->skipHex(this->current, this->end);
     }
 
     return newToken(TOKEN_LITERAL);
 }
 
-void Scanner::skipWhitespace() {
-    while (true) {
-        char c = peek();
-
-        if (c == ' ' || c == '\t') {
-            advance();
-        } else {
-            return;
-        }
+// strings end on the same line, the token keeps its quotes
+Token Scanner::string() {
+    while (peek() != '"' && peek() != '\n' && !isAtEnd()) {
+        advance();
     }
-}
-
-void Scanner::comment() {
-    while (!isAtEnd()) {
-        char c = advance();
-        if (c == '\n') {
-            line++;
-            return;
-        }
+    if (peek() != '"') {
+        error('"', "Unterminated string.");
+    } else {
+        advance();
     }
+    return newToken(TOKEN_STRING);
 }
 
-TokenType Scanner::checkInstruction(int start, int length, const char *rest,
-                                    TokenType type) {
-    if (this->current - this->start == start + length &&
-        memcmp(this->start + start, rest, length) == 0) {
-        return type;
-    }
+void Scanner::skipWhitespace() {
+    this->current = kernels->skipBlanks(this->current, this->end);
+}
 
-    return TOKEN_IDENTIFIER;
+// the newline is left for scan() so the statement still gets terminated
+void Scanner::comment() {
+    this->current = kernels->findNewline(this->current, this->end);
 }
 
 TokenType Scanner::identifierOrInstruction() {
-    int tokenLength = this->current - this->start;
-    if (tokenLength > 4)
-        return TOKEN_IDENTIFIER;
-
-    switch (this->start[0]) {
-        case 'A': {
-            switch (this->start[1]) {
-                case 'D': {
-                    return checkInstruction(2, 1, "D", TOKEN_INST_ADD);
-                } break;
-                case 'N': {
-                    return checkInstruction(2, 1, "D", TOKEN_INST_AND);
-                } break;
-            }
-        } break;
-        case 'B': {
-            return checkInstruction(1, 2, "CD", TOKEN_INST_BCD);
-        } break;
-        case 'C': {
-            switch (this->start[1]) {
-                case 'L': {
-                    return checkInstruction(2, 1, "S", TOKEN_INST_CLS);
-                } break;
-                case 'A': {
-                    return checkInstruction(2, 2, "LL", TOKEN_INST_CALL);
-                } break;
-            }
-        } break;
-        case 'D': {
-            return checkInstruction(1, 2, "RW", TOKEN_INST_DRW);
-        } break;
-        case 'F': {
-            return checkInstruction(1, 2, "NT", TOKEN_INST_FNT);
-        } break;
-        case 'G': {
-            return checkInstruction(1, 2, "DT", TOKEN_INST_GDT);
-        } break;
-        case 'J': {
-            if (tokenLength == 2) {
-                return checkInstruction(1, 1, "P", TOKEN_INST_JP);
-            } else {
-                return checkInstruction(1, 2, "PO", TOKEN_INST_JPO);
-            }
-        } break;
-        case 'L': {
-            if (tokenLength == 2) {
-                return checkInstruction(1, 1, "D", TOKEN_INST_LD);
-            } else {
-                return checkInstruction(1, 2, "DV", TOKEN_INST_LDV);
-            }
-        } break;
-        case 'O': {
-            return checkInstruction(1, 1, "R", TOKEN_INST_OR);
-        } break;
-        case 'R': {
-            switch (this->start[1]) {
-                case 'E': {
-                    return checkInstruction(2, 1, "T", TOKEN_INST_RET);
-                } break;
-                case 'N': {
-                    return checkInstruction(2, 1, "D", TOKEN_INST_RND);
-                }
-            }
-        } break;
-        case 'S': {
-            switch (this->start[1]) {
-                case 'U': {
-                    if (tokenLength == 3) {
-                        return checkInstruction(2, 1, "B", TOKEN_INST_SUB);
-                    } else {
-                        return checkInstruction(2, 2, "BN", TOKEN_INST_SUBN);
-                    }
-                } break;
-                case 'K': {
-                    if (tokenLength == 3) {
-                        return checkInstruction(2, 1, "P", TOKEN_INST_SKP);
-                    } else {
-                        return checkInstruction(2, 2, "NP", TOKEN_INST_SKNP);
-                    }
-                } break;
-                case 'H': {
-                    if (this->start[1] == 'H') {
-                        if (tokenLength == 3) {
-                            if (this->start[2] == 'L') {
-                                return TOKEN_INST_SHL;
-                            } else if (this->start[2] == 'R') {
-                                return TOKEN_INST_SHR;
-                            }
-                        }
-                    }
-                    return TOKEN_IDENTIFIER;
-                } break;
-                case 'E': {
-                    return checkInstruction(0, 2, "SE", TOKEN_INST_SE);
-                } break;
-                case 'N': {
-                    return checkInstruction(2, 1, "E", TOKEN_INST_SNE);
-                } break;
-                case 'D': {
-                    return checkInstruction(2, 1, "T", TOKEN_INST_SDT);
-                } break;
-                case 'S': {
-                    return checkInstruction(2, 1, "T", TOKEN_INST_SST);
-                } break;
-                case 'T': {
-                    return checkInstruction(2, 1, "V", TOKEN_INST_STV);
-                } break;
-            }
-        } break;
-        case 'W': {
-            return checkInstruction(1, 2, "KP", TOKEN_INST_WKP);
-        } break;
-        case 'X': {
-            return checkInstruction(1, 2, "OR", TOKEN_INST_XOR);
-        } break;
-    }
-
-    return TOKEN_IDENTIFIER;
+    return lookupInstruction(this->start, this->current - this->start);
 }
 
 Token Scanner::identifier(char c) {
@@ -225,51 +121,72 @@ Token Scanner::identifier(char c) {
     while (isAlpha(peek())) {
         advance();
     }
-    return newToken(identifierOrInstruction());
+    Token token = newToken(identifierOrInstruction());
+    if (token.type == TOKEN_IDENTIFIER && symbols != nullptr) {
+        token.symbol = symbols->intern(this->start, token.length);
+    }
+    return token;
 }
 
-void Scanner::scan(std::vector<Token> *vector) {
-    while (!isAtEnd()) {
-
+// returns false once the end of the source is reached
+bool Scanner::scanToken(Token *token) {
+    while (true) {
         skipWhitespace();
+        if (isAtEnd())
+            return false;
         this->start = this->current;
         char c = advance();
 
         if (isAlpha(c)) {
-            vector->push_back(identifier(c));
-            continue;
+            *token = identifier(c);
+            return true;
         }
 
         switch (c) {
             case ':': {
-                vector->push_back(newToken(TOKEN_COLON));
+                *token = newToken(TOKEN_COLON);
             } break;
             case '.': {
-                vector->push_back(newToken(TOKEN_DOT));
+                *token = newToken(TOKEN_DOT);
             } break;
             case ',': {
-                vector->push_back(newToken(TOKEN_COMMA));
+                *token = newToken(TOKEN_COMMA);
             } break;
             case '\n': {
-                vector->push_back(newToken(TOKEN_NEWLINE));
-                this->line++;
+                *token = newToken(TOKEN_NEWLINE);
                 this->panicMode = false;
             } break;
             case '=': {
-                vector->push_back(newToken(TOKEN_EQUAL));
+                *token = newToken(TOKEN_EQUAL);
             } break;
             case '$': {
-                vector->push_back(literal());
+                *token = literal();
             } break;
             case '%': {
-                vector->push_back(literal());
+                *token = literal();
+            } break;
+            case '"': {
+                *token = string();
             } break;
             case ';': {
                 comment();
+                continue;
             } break;
             default: {
-                error(this->line, c, "Unexpected character.");
+                error(c, "Unexpected character.");
+                continue;
             } break;
         }
+        return true;
+    }
+}
+
+void Scanner::scan(TokenList *vector) {
+    // rough guess for typical sources, saves most of the regrowth
+    vector->reserve(vector->size() + (this->end - this->current) / 4 + 16);
+
+    Token token;
+    while (scanToken(&token)) {
+        vector->push_back(token);
     }
-}
\ No newline at end of file
+}
@@ -1,22 +1,35 @@
 #pragma once
 
+#include <stddef.h>
 #include <vector>
 
+#include "diagnostics.h"
+#include "fastscan.h"
+#include "lines.h"
+#include "symbols.h"
 #include "token.h"
 
 class Scanner {
   public:
     bool hadError;
-    Scanner(const char *source);
-    void scan(std::vector<Token> *vector);
+    Scanner(const char *source, size_t length, SymbolTable *symbols,
+            Diagnostics *diagnostics, const ScanKernels *kernels = nullptr);
+    void setRange(size_t begin, size_t end);
+    void scan(TokenList *vector);
+    bool scanToken(Token *token);
 
   private:
+    const char *source;
     const char *start;
     const char *current;
-    int line;
+    const char *end;
+    SymbolTable *symbols;
+    Diagnostics *diagnostics;
+    const ScanKernels *kernels;
     bool panicMode;
+    LineIndex lines;
 
-    void error(int line, char c, const char *message);
+    void error(char c, const char *message);
 
     char previous();
     char advance();
@@ -28,9 +41,8 @@ class Scanner {
     void comment();
 
     Token literal();
+    Token string();
     Token identifier(char c);
 
-    TokenType checkInstruction(int start, int length, const char *rest,
-                               TokenType type);
     TokenType identifierOrInstruction();
 };
@@ -0,0 +1,284 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "bytes.h"
+#include "server.h"
+
+static bool readAll(int fd, void *data, size_t length) {
+    char *at = (char *)data;
+    while (length > 0) {
+        ssize_t count = recv(fd, at, length, 0);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            return false;
+        at += count;
+        length -= count;
+    }
+    return true;
+}
+
+// MSG_NOSIGNAL, a client that went away must not take the server with it
+static bool writeAll(int fd, const void *data, size_t length) {
+    const char *at = (const char *)data;
+    while (length > 0) {
+        ssize_t count = send(fd, at, length, MSG_NOSIGNAL);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            return false;
+        at += count;
+        length -= count;
+    }
+    return true;
+}
+
+static bool readU32(int fd, uint32_t *value) {
+    uint8_t bytes[4];
+    if (!readAll(fd, bytes, 4))
+        return false;
+    *value = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (uint32_t)bytes[3]
+                                                            << 24;
+    return true;
+}
+
+static bool openSocket(const char *path, sockaddr_un *address, int *fd) {
+    if (strlen(path) >= sizeof(address->sun_path))
+        return false;
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    strcpy(address->sun_path, path);
+    *fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    return *fd >= 0;
+}
+
+// what a worker keeps between requests, so a warm worker does not allocate
+// them again for each one
+typedef struct {
+    Assembler assembler;
+    Output output;
+    Diagnostics diagnostics;
+    std::vector<char> request;
+    std::vector<char> response;
+} ServerWorker;
+
+static bool respond(int fd, ServerWorker *w, AssembleStatus status,
+                    const std::vector<Dependency> &dependencies) {
+    w->response.clear();
+    putU32(&w->response, 0); // the length, filled in once it is known
+    putU32(&w->response, dependencies.size());
+    for (const Dependency &dependency : dependencies) {
+        putString(&w->response, dependency.path);
+        putU64(&w->response, dependency.hash);
+    }
+    encodeResult(status, w->output, w->diagnostics, &w->response);
+    uint32_t length = w->response.size() - 4;
+    for (int i = 0; i < 4; i++) {
+        w->response[i] = (char)(length >> (i * 8));
+    }
+    return writeAll(fd, w->response.data(), w->response.size());
+}
+
+// Answers one request, false when the connection is done with. A request
+// over MAX_REQUEST_LENGTH is answered without being read, so the rest of
+// the connection can not be made sense of either.
+static bool serveRequest(int fd, ServerWorker *w) {
+    static const std::vector<Dependency> none;
+    uint32_t length;
+    if (!readU32(fd, &length))
+        return false;
+    w->output.length = 0;
+    w->diagnostics.list.clear();
+    if (length > MAX_REQUEST_LENGTH) {
+        respond(fd, w, ASSEMBLE_SOURCE_TOO_LARGE, none);
+        return false;
+    }
+    w->request.resize(length);
+    if (!readAll(fd, w->request.data(), length))
+        return false;
+    Reader reader = {(const uint8_t *)w->request.data(),
+                     (const uint8_t *)w->request.data() + length};
+    if (!getString(&reader, &w->assembler.path))
+        return false;
+    AssembleStatus status =
+        w->assembler.assemble((const char *)reader.at, reader.end - reader.at,
+                              &w->output, &w->diagnostics);
+    return respond(fd, w, status, w->assembler.dependencies);
+}
+
+// A new connection is watched for requests along with all the others. It
+// is armed for a single wake up, so only the worker that got it reads it
+// until that worker arms it again.
+static void acceptConnection(int listener, int poller) {
+    int fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0)
+        return; // taken by another worker, or the client is gone
+    // a client that stops halfway through a request, or does not read its
+    // answer, lets go of the worker
+    timeval timeout = {REQUEST_TIMEOUT, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.fd = fd;
+    if (epoll_ctl(poller, EPOLL_CTL_ADD, fd, &event) < 0)
+        close(fd);
+}
+
+// All workers wait on the same epoll instance for a new connection or a
+// request on any open one, so clients that keep a connection open but idle
+// do not hold up a worker.
+static void worker(int listener, int poller, IncludeCache *includes) {
+    ServerWorker w;
+    w.assembler.includes = includes;
+    while (true) {
+        epoll_event event;
+        int count = epoll_wait(poller, &event, 1, -1);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            return;
+        int fd = event.data.fd;
+        if (fd == listener) {
+            acceptConnection(listener, poller);
+            continue;
+        }
+        // a hung up or broken connection fails the read
+        event.events = EPOLLIN | EPOLLONESHOT;
+        if (!serveRequest(fd, &w) ||
+            epoll_ctl(poller, EPOLL_CTL_MOD, fd, &event) < 0)
+            close(fd);
+    }
+}
+
+// Only a socket is ever removed from path, and only one that no server is
+// listening on any more.
+static bool claimPath(const char *path, const sockaddr_un &address) {
+    struct stat info;
+    if (lstat(path, &info) < 0)
+        return errno == ENOENT;
+    if (!S_ISSOCK(info.st_mode))
+        return false;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+    bool live = connect(fd, (sockaddr *)&address, sizeof(address)) == 0;
+    close(fd);
+    return !live && unlink(path) == 0;
+}
+
+bool serve(const char *path, int threads) {
+    sockaddr_un address;
+    int listener;
+    if (!openSocket(path, &address, &listener))
+        return false;
+    int poller = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = listener;
+    // the listener does not block, a worker that lost the race to accept a
+    // connection goes back to waiting
+    if (poller < 0 || !claimPath(path, address) ||
+        fcntl(listener, F_SETFL, O_NONBLOCK) < 0 ||
+        bind(listener, (sockaddr *)&address, sizeof(address)) < 0 ||
+        listen(listener, SOMAXCONN) < 0 ||
+        epoll_ctl(poller, EPOLL_CTL_ADD, listener, &event) < 0) {
+        if (poller >= 0)
+            close(poller);
+        close(listener);
+        return false;
+    }
+
+    if (threads < 1)
+        threads = 1;
+    IncludeCache includes;
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) {
+        pool.emplace_back(worker, listener, poller, &includes);
+    }
+    worker(listener, poller, &includes);
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+    close(poller);
+    close(listener);
+    return false;
+}
+
+int connectServer(const char *path) {
+    sockaddr_un address;
+    int fd;
+    if (!openSocket(path, &address, &fd))
+        return -1;
+    if (connect(fd, (sockaddr *)&address, sizeof(address)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// the server has a working directory of its own
+static std::string absolutePath(const char *path) {
+    char cwd[PATH_MAX];
+    if (path[0] == '/' || getcwd(cwd, sizeof(cwd)) == nullptr)
+        return path;
+    return std::string(cwd) + "/" + path;
+}
+
+RemoteStatus remoteAssemble(int fd, const char *path, const char *source,
+                            size_t length, Output *output,
+                            Diagnostics *diagnostics,
+                            std::vector<Dependency> *dependencies,
+                            AssembleStatus *status) {
+    std::vector<char> request;
+    putU32(&request, 0);
+    putString(&request, absolutePath(path));
+    if (request.size() - 4 + length > MAX_REQUEST_LENGTH) {
+        output->length = 0;
+        *status = ASSEMBLE_SOURCE_TOO_LARGE;
+        return REMOTE_OK;
+    }
+    uint32_t size = request.size() - 4 + length;
+    for (int i = 0; i < 4; i++) {
+        request[i] = (char)(size >> (i * 8));
+    }
+    if (!writeAll(fd, request.data(), request.size()) ||
+        !writeAll(fd, source, length))
+        return REMOTE_UNREACHABLE;
+
+    if (!readU32(fd, &size))
+        return REMOTE_UNREACHABLE;
+    if (size > MAX_REQUEST_LENGTH)
+        return REMOTE_BAD_RESPONSE;
+    std::vector<char> response(size);
+    if (!readAll(fd, response.data(), size))
+        return REMOTE_UNREACHABLE;
+    Reader reader = {(const uint8_t *)response.data(),
+                     (const uint8_t *)response.data() + size};
+    uint32_t count;
+    if (!getU32(&reader, &count))
+        return REMOTE_BAD_RESPONSE;
+    dependencies->clear();
+    for (uint32_t i = 0; i < count; i++) {
+        Dependency dependency;
+        if (!getString(&reader, &dependency.path) ||
+            !getU64(&reader, &dependency.hash))
+            return REMOTE_BAD_RESPONSE;
+        dependencies->push_back(dependency);
+    }
+    if (!decodeResult((const char *)reader.at, reader.end - reader.at, status,
+                      output, diagnostics))
+        return REMOTE_BAD_RESPONSE;
+    return REMOTE_OK;
+}
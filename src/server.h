@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+#include "assembler.h"
+#include "diagnostics.h"
+#include "include.h"
+
+// Every message on the socket is prefixed with its length as a 32 bit little
+// endian integer. A request is the absolute path of the source as a length
+// prefixed string (see bytes.h), then the source. A response is the count of
+// the files it included, the path and 64 bit hash of each, then the
+// encodeResult() of its assembly. A connection may send any number of
+// requests, one after the other.
+
+// larger requests are answered with ASSEMBLE_SOURCE_TOO_LARGE unread, after
+// which the server closes the connection. Clients take larger responses
+// for a broken server.
+#define MAX_REQUEST_LENGTH (64 << 20)
+// seconds a request may take to arrive once it has begun, and its answer
+// to be taken
+#define REQUEST_TIMEOUT 10
+
+typedef enum {
+    REMOTE_OK,
+    REMOTE_UNREACHABLE,  // the connection failed
+    REMOTE_BAD_RESPONSE, // the answer could not be decoded
+} RemoteStatus;
+
+// Accepts clients on a Unix domain socket at path until the process is
+// killed. Each of the threads workers keeps one warm Assembler and takes
+// whichever request comes next on any connection, so any number of clients
+// can keep their connection open. Includes are looked up relative to the
+// path that came with the source. Anything at path other than a socket no
+// server listens on is left alone. Returns false if the socket can not be
+// set up.
+bool serve(const char *path, int threads);
+
+// Returns a connected socket or -1.
+int connectServer(const char *path);
+
+// Assembles source, read from path, on the server behind fd. On REMOTE_OK
+// status, output, diagnostics and dependencies are filled in just like
+// Assembler::assemble() would.
+RemoteStatus remoteAssemble(int fd, const char *path, const char *source,
+                            size_t length, Output *output,
+                            Diagnostics *diagnostics,
+                            std::vector<Dependency> *dependencies,
+                            AssembleStatus *status);
@@ -0,0 +1,134 @@
+#include <string.h>
+#include <time.h>
+
+#include "stats.h"
+
+std::atomic<bool> allocationCounting(false);
+std::atomic<uint64_t> allocationCount(0);
+std::atomic<uint64_t> allocationBytes(0);
+
+static const char *phaseNames[PHASE_COUNT] = {
+    "read", "scan", "include", "compile", "fixups", "write",
+};
+
+static const char *tokenNames[TOKEN_TYPE_COUNT] = {
+    "newline", "comma", "dot",  "colon", "equal", "string", "identifier",
+    "literal", "v_register", "i_register", "cls", "ret", "jp", "jpo",
+    "call", "se", "sne", "ld", "add", "and", "or", "xor", "sub", "shr",
+    "subn", "shl", "rnd", "drw", "skp", "sknp", "gdt", "wkp", "sdt", "sst",
+    "fnt", "bcd", "stv", "ldv",
+};
+static_assert(TOKEN_INST_LDV == 37, "tokenNames is out of date");
+
+static double cpuSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+Stats::Stats() {
+    memset(phases, 0, sizeof(phases));
+    memset(tokens, 0, sizeof(tokens));
+    sourceBytes = 0;
+    symbols = 0;
+    symbolLookups = 0;
+    symbolProbes = 0;
+    arenaPeak = 0;
+    arenaReserved = 0;
+    allocations = 0;
+    allocatedBytes = 0;
+}
+
+void Stats::countTokens(const TokenList &list) {
+    for (const Token &token : list) {
+        tokens[token.type]++;
+    }
+}
+
+void Stats::print(FILE *stream, const char *file) {
+    fprintf(stream, "%s: %zu bytes\n", file, sourceBytes);
+    fprintf(stream, "  %-10s %10s %10s\n", "phase", "wall ms", "cpu ms");
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        // fixups are part of compile
+        bool nested = p == PHASE_FIXUPS;
+        fprintf(stream, "  %s%-*s %10.3f %10.3f\n", nested ? "  " : "",
+                nested ? 8 : 10, phaseNames[p],
+                phases[p].wall * 1e3, phases[p].cpu * 1e3);
+    }
+    uint64_t total = 0;
+    fprintf(stream, "  tokens:");
+    for (int t = 0; t < TOKEN_TYPE_COUNT; t++) {
+        total += tokens[t];
+        if (tokens[t] > 0)
+            fprintf(stream, " %s %llu", tokenNames[t],
+                    (unsigned long long)tokens[t]);
+    }
+    fprintf(stream, " (%llu in all)\n", (unsigned long long)total);
+    fprintf(stream, "  symbols: %d, %llu lookups, %.2f probes per lookup\n",
+            symbols, (unsigned long long)symbolLookups,
+            symbolLookups > 0 ? (double)symbolProbes / symbolLookups : 0.0);
+    fprintf(stream, "  arena: %zu bytes peak, %zu reserved\n", arenaPeak,
+            arenaReserved);
+    fprintf(stream, "  heap: %llu allocations, %llu bytes\n",
+            (unsigned long long)allocations,
+            (unsigned long long)allocatedBytes);
+}
+
+// file names go into a JSON string
+static void printString(FILE *stream, const char *text) {
+    fputc('"', stream);
+    for (; *text != '\0'; text++) {
+        unsigned char c = *text;
+        if (c == '"' || c == '\\')
+            fprintf(stream, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(stream, "\\u%04x", c);
+        else
+            fputc(c, stream);
+    }
+    fputc('"', stream);
+}
+
+void Stats::printJson(FILE *stream, const char *file) {
+    fprintf(stream, "{\"file\": ");
+    printString(stream, file);
+    fprintf(stream, ", \"bytes\": %zu, \"phases\": {", sourceBytes);
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        fprintf(stream, "%s\"%s\": {\"wall\": %.6f, \"cpu\": %.6f}",
+                p > 0 ? ", " : "", phaseNames[p], phases[p].wall,
+                phases[p].cpu);
+    }
+    fprintf(stream, "}, \"tokens\": {");
+    for (int t = 0; t < TOKEN_TYPE_COUNT; t++) {
+        fprintf(stream, "%s\"%s\": %llu", t > 0 ? ", " : "", tokenNames[t],
+                (unsigned long long)tokens[t]);
+    }
+    fprintf(stream,
+            "}, \"symbols\": {\"count\": %d, \"lookups\": %llu, "
+            "\"probes\": %llu}, \"arena\": {\"peak\": %zu, "
+            "\"reserved\": %zu}, \"heap\": {\"allocations\": %llu, "
+            "\"bytes\": %llu}}\n",
+            symbols, (unsigned long long)symbolLookups,
+            (unsigned long long)symbolProbes, arenaPeak, arenaReserved,
+            (unsigned long long)allocations,
+            (unsigned long long)allocatedBytes);
+}
+
+PhaseTimer::PhaseTimer(Stats *stats, Phase phase) {
+    this->stats = stats;
+    this->phase = phase;
+    if (stats != nullptr) {
+        wall = std::chrono::steady_clock::now();
+        cpu = cpuSeconds();
+    }
+}
+
+PhaseTimer::~PhaseTimer() {
+    if (stats != nullptr) {
+        stats->phases[phase].wall +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                          wall)
+                .count();
+        stats->phases[phase].cpu += cpuSeconds() - cpu;
+    }
+}
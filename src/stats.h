@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "token.h"
+
+typedef enum {
+    PHASE_READ,
+    PHASE_SCAN,
+    PHASE_INCLUDE,
+    PHASE_COMPILE,
+    PHASE_FIXUPS, // part of PHASE_COMPILE
+    PHASE_WRITE,
+    PHASE_COUNT,
+} Phase;
+
+typedef struct {
+    double wall;
+    double cpu; // of the whole process, so threads add up
+} PhaseTime;
+
+// What --stats reports for one file. Whoever runs a phase times it with a
+// PhaseTimer, everything else is filled in once the phase is done.
+class Stats {
+  public:
+    Stats();
+
+    PhaseTime phases[PHASE_COUNT];
+    size_t sourceBytes;
+    uint64_t tokens[TOKEN_TYPE_COUNT];
+    int symbols;
+    uint64_t symbolLookups;
+    uint64_t symbolProbes;
+    size_t arenaPeak;
+    size_t arenaReserved;
+    uint64_t allocations;
+    uint64_t allocatedBytes;
+
+    void countTokens(const TokenList &list);
+    void print(FILE *stream, const char *file);
+    void printJson(FILE *stream, const char *file);
+};
+
+// adds the time until it goes out of scope to a phase, does nothing
+// without stats
+class PhaseTimer {
+  public:
+    PhaseTimer(Stats *stats, Phase phase);
+    ~PhaseTimer();
+
+  private:
+    Stats *stats;
+    Phase phase;
+    std::chrono::steady_clock::time_point wall;
+    double cpu;
+};
+
+// Heap allocations through operator new. The library only keeps the
+// counters, the executable that wants them replaces operator new and calls
+// countAllocation() (see main.cpp), so embedders keep their own allocator.
+extern std::atomic<bool> allocationCounting;
+extern std::atomic<uint64_t> allocationCount;
+extern std::atomic<uint64_t> allocationBytes;
+
+inline void countAllocation(size_t size) {
+    if (allocationCounting.load(std::memory_order_relaxed)) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,92 @@
+#include <string.h>
+
+#include "symbols.h"
+
+#define INITIAL_SLOTS 64
+
+// FNV-1a, identifiers are short so anything fancier does not pay off
+uint32_t hashName(const char *start, int length) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash ^= (uint8_t)start[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+SymbolTable::SymbolTable(Arena *arena, bool copyNames)
+    : symbols(arena), slots(arena) {
+    this->arena = arena;
+    this->copyNames = copyNames;
+    this->lookupCount = 0;
+    this->probeCount = 0;
+    clear();
+}
+
+void SymbolTable::clear() {
+    symbols.clear();
+    slots.assign(INITIAL_SLOTS, NO_SYMBOL);
+    mask = INITIAL_SLOTS - 1;
+}
+
+void SymbolTable::clearDefinitions() {
+    for (Symbol &symbol : symbols) {
+        symbol.kind = SYMBOL_UNDEFINED;
+        symbol.value = 0;
+        symbol.definedAt = 0;
+    }
+}
+
+int *SymbolTable::findSlot(std::string_view name, uint32_t hash) {
+    uint32_t index = hash & mask;
+    lookupCount++;
+    while (true) {
+        int *slot = &slots[index];
+        probeCount++;
+        if (*slot == NO_SYMBOL)
+            return slot;
+        const Symbol &symbol = symbols[*slot];
+        if (symbol.hash == hash && symbol.name == name)
+            return slot;
+        index = (index + 1) & mask;
+    }
+}
+
+// keeps the load factor at or below one half
+void SymbolTable::grow() {
+    slots.assign(slots.size() * 2, NO_SYMBOL);
+    mask = slots.size() - 1;
+    for (int id = 0; id < (int)symbols.size(); id++) {
+        uint32_t index = symbols[id].hash & mask;
+        while (slots[index] != NO_SYMBOL) {
+            index = (index + 1) & mask;
+        }
+        slots[index] = id;
+    }
+}
+
+int SymbolTable::find(const char *start, int length) {
+    std::string_view name(start, length);
+    return *findSlot(name, hashName(start, length));
+}
+
+int SymbolTable::intern(const char *start, int length) {
+    std::string_view name(start, length);
+    uint32_t hash = hashName(start, length);
+    int *slot = findSlot(name, hash);
+    if (*slot != NO_SYMBOL)
+        return *slot;
+
+    if (copyNames) {
+        char *copy = (char *)arena->allocate(length, 1);
+        memcpy(copy, start, length);
+        name = std::string_view(copy, length);
+    }
+    int id = (int)symbols.size();
+    symbols.push_back({name, hash, SYMBOL_UNDEFINED, 0, 0});
+    *slot = id;
+    if (symbols.size() * 2 > slots.size()) {
+        grow();
+    }
+    return id;
+}
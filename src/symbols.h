@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <string_view>
+#include <vector>
+
+#include "arena.h"
+
+#define NO_SYMBOL -1
+
+typedef enum {
+    SYMBOL_UNDEFINED,
+    SYMBOL_LABEL,
+    SYMBOL_VARIABLE,
+} SymbolKind;
+
+typedef struct {
+    std::string_view name; // points into the source buffer
+    uint32_t hash;
+    SymbolKind kind;
+    uint16_t value;
+    uint32_t definedAt; // source offset of the defining token
+} Symbol;
+
+// Interns identifiers to dense integer ids. Names are views into the source,
+// so interning never copies a string, and the table is an open addressing
+// hash over the ids that compares the stored hash before the name. A table
+// that outlives its source (see watch.cpp) copies the names into the arena.
+class SymbolTable {
+  public:
+    SymbolTable(Arena *arena, bool copyNames = false);
+    int intern(const char *start, int length);
+    int find(const char *start, int length);
+    Symbol *get(int id) { return &symbols[id]; }
+    int count() { return (int)symbols.size(); }
+    // for --stats, more than one probe per lookup means clustering
+    uint64_t lookups() { return lookupCount; }
+    uint64_t probes() { return probeCount; }
+
+    // forgets all label and variable values but keeps the interned names
+    void clearDefinitions();
+    void clear();
+
+  private:
+    std::vector<Symbol, ArenaAllocator<Symbol>> symbols;
+    std::vector<int, ArenaAllocator<int>> slots;
+    uint32_t mask;
+    uint64_t lookupCount;
+    uint64_t probeCount;
+    Arena *arena;
+    bool copyNames;
+
+    int *findSlot(std::string_view name, uint32_t hash);
+    void grow();
+};
+
+uint32_t hashName(const char *start, int length);
@@ -1,13 +1,17 @@
 #pragma once
 
+#include <stdint.h>
 #include <vector>
 
+#include "arena.h"
+
 typedef enum {
     TOKEN_NEWLINE,
     TOKEN_COMMA,
     TOKEN_DOT,
     TOKEN_COLON,
     TOKEN_EQUAL,
+    TOKEN_STRING, // "...", only for directives
 
     TOKEN_IDENTIFIER, // Variable, Label
     TOKEN_LITERAL,
@@ -44,9 +48,24 @@ typedef enum {
     TOKEN_INST_LDV,
 } TokenType;
 
+#define TOKEN_TYPE_COUNT (TOKEN_INST_LDV + 1)
+
+// Tokens are kept small so large sources stay cache friendly: the text is
+// addressed by offset into the source and lines are recovered through a
+// LineIndex when a diagnostic needs them. Offset, length and type alone
+// would fit in 8 bytes, the symbol id costs the other 4 (and a byte of
+// padding) but saves hashing an identifier again every time the compiler
+// meets it.
 typedef struct {
-    TokenType type;
-    const char *start;
-    int length;
-    int line;
+    uint32_t start; // offset into the source
+    int32_t symbol; // SymbolTable id for identifiers, NO_SYMBOL otherwise
+    uint16_t length;
+    uint8_t type; // TokenType
 } Token;
+
+static_assert(sizeof(Token) == 12, "Token should stay 12 bytes");
+
+#define MAX_TOKEN_LENGTH UINT16_MAX
+#define MAX_SOURCE_LENGTH UINT32_MAX
+
+typedef std::vector<Token, ArenaAllocator<Token>> TokenList;
@@ -0,0 +1,9 @@
+#include "tokenring.h"
+
+TokenRing::TokenRing(size_t capacity) : head(0), tail(0), closed(false) {
+    size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+    slots.resize(size);
+    mask = size - 1;
+}
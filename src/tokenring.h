@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <thread>
+#include <vector>
+
+#include "token.h"
+
+// Lock-free single producer / single consumer queue of tokens with a fixed
+// power of two capacity. The producer blocks (yielding) while it is full and
+// the consumer while it is empty, so memory stays bounded by the capacity.
+class TokenRing {
+  public:
+    TokenRing(size_t capacity);
+
+    // producer side
+    void push(const Token &token) {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        while (tail - head.load(std::memory_order_acquire) == slots.size()) {
+            std::this_thread::yield();
+        }
+        slots[tail & mask] = token;
+        this->tail.store(tail + 1, std::memory_order_release);
+    }
+    void close() { closed.store(true, std::memory_order_release); }
+
+    // consumer side, false once the ring is closed and drained
+    bool pop(Token *token) {
+        size_t head = this->head.load(std::memory_order_relaxed);
+        while (head == tail.load(std::memory_order_acquire)) {
+            if (closed.load(std::memory_order_acquire) &&
+                head == tail.load(std::memory_order_acquire))
+                return false;
+            std::this_thread::yield();
+        }
+        *token = slots[head & mask];
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+  private:
+    std::vector<Token> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+    std::atomic<bool> closed;
+};
@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <memory>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "arena.h"
+#include "assembler.h"
+#include "compiler.h"
+#include "io.h"
+#include "scanner.h"
+#include "symbols.h"
+#include "token.h"
+#include "watch.h"
+
+// whole blocks first, memcmp is far quicker than comparing byte by byte
+static size_t commonPrefix(const char *a, const char *b, size_t length) {
+    size_t i = 0;
+    while (i + 64 <= length && memcmp(a + i, b + i, 64) == 0)
+        i += 64;
+    while (i < length && a[i] == b[i])
+        i++;
+    return i;
+}
+
+static size_t commonSuffix(const char *aEnd, const char *bEnd,
+                           size_t length) {
+    size_t i = 0;
+    while (i + 64 <= length && memcmp(aEnd - i - 64, bEnd - i - 64, 64) == 0)
+        i += 64;
+    while (i < length && aEnd[-1 - (long)i] == bEnd[-1 - (long)i])
+        i++;
+    return i;
+}
+
+static size_t firstAt(const TokenList &tokens, size_t offset) {
+    return std::lower_bound(tokens.begin(), tokens.end(), offset,
+                            [](const Token &token, size_t offset) {
+                                return token.start < offset;
+                            }) -
+           tokens.begin();
+}
+
+// The tokens and names of the versions scanned since the arena was last
+// reset. Symbol ids stay valid across versions, the table copies the names.
+typedef struct ScanState {
+    TokenList tokens;
+    TokenList edited;
+    SymbolTable symbols;
+
+    ScanState(Arena *arena)
+        : tokens(arena), edited(arena), symbols(arena, true) {}
+} ScanState;
+
+IncrementalAssembler::IncrementalAssembler() {
+    this->scannedBegin = 0;
+    this->scannedEnd = 0;
+    this->hadScanError = false;
+    this->hasVersion = false;
+    this->firstScanned = 0;
+    this->freshUsed = 0;
+}
+
+IncrementalAssembler::~IncrementalAssembler() {}
+
+bool IncrementalAssembler::scanRange(size_t begin, size_t end,
+                                     TokenList *tokens) {
+    Scanner scanner(text.data(), text.size(), &scan->symbols, &diagnostics);
+    scanner.setRange(begin, end);
+    scanner.scan(tokens);
+    scannedBegin = begin;
+    scannedEnd = end;
+    return !scanner.hadError;
+}
+
+// Outgrown token buffers and the names of every version stay in the arena
+// until it is reset, so once it holds several times what a full scan left
+// in it everything is scanned again from an empty one.
+bool IncrementalAssembler::arenaOutgrown() {
+    return arena.used() > ARENA_GROWTH_LIMIT * freshUsed + ARENA_SLACK;
+}
+
+// Narrows the edit down to whole lines by the common prefix and suffix of
+// both texts. Tokens never cross a newline and the scanner starts every line
+// afresh, so only the tokens of those lines are replaced and the ones after
+// them shifted by the change in length. Returns false when everything had to
+// be scanned.
+bool IncrementalAssembler::rescan() {
+    const std::string &a = previousText;
+    const std::string &b = text;
+    if (!hasVersion || hadScanError || arenaOutgrown()) {
+        // errors outside the edited lines would not be reported again. The
+        // compiler refers to the symbols, it starts over too.
+        compiler.reset();
+        scan.reset();
+        arena.reset();
+        scan = std::make_unique<ScanState>(&arena);
+        firstScanned = 0;
+        hadScanError = !scanRange(0, b.size(), &scan->tokens);
+        freshUsed = arena.used();
+        return false;
+    }
+
+    size_t shorter = a.size() < b.size() ? a.size() : b.size();
+    size_t prefix = commonPrefix(a.data(), b.data(), shorter);
+    size_t suffix = commonSuffix(a.data() + a.size(), b.data() + b.size(),
+                                 shorter - prefix);
+
+    size_t begin = prefix == 0 ? std::string::npos : a.rfind('\n', prefix - 1);
+    begin = begin == std::string::npos ? 0 : begin + 1;
+    size_t oldEnd = a.find('\n', a.size() - suffix);
+    oldEnd = oldEnd == std::string::npos ? a.size() : oldEnd + 1;
+    long delta = (long)b.size() - (long)a.size();
+
+    TokenList &tokens = scan->tokens;
+    scan->edited.clear();
+    hadScanError = !scanRange(begin, oldEnd + delta, &scan->edited);
+    size_t first = firstAt(tokens, begin);
+    size_t last = firstAt(tokens, oldEnd);
+    tokens.erase(tokens.begin() + first, tokens.begin() + last);
+    tokens.insert(tokens.begin() + first, scan->edited.begin(),
+                  scan->edited.end());
+    for (size_t i = first + scan->edited.size(); i < tokens.size(); i++) {
+        tokens[i].start += delta;
+    }
+    firstScanned = first;
+    return true;
+}
+
+bool IncrementalAssembler::compileVersion(bool partial) {
+    if (partial && compiler != nullptr) {
+        output.length =
+            compiler->recompile(&scan->tokens, text.data(), text.size(),
+                                firstScanned, scannedBegin);
+    } else {
+        compiler.reset();
+        compilerArena.reset();
+        scan->symbols.clearDefinitions();
+        compiler = std::make_unique<Compiler>(&scan->tokens, text.data(),
+                                              text.size(), &scan->symbols,
+                                              &compilerArena, &diagnostics);
+        compiler->resumable = true;
+        output.length = compiler->compile(output.data, (int)output.capacity);
+    }
+    if (compiler->hadError) {
+        compiler.reset();
+        return false;
+    }
+    return true;
+}
+
+AssembleStatus IncrementalAssembler::assemble(const char *source,
+                                              size_t length) {
+    diagnostics.clear();
+    if (length > MAX_SOURCE_LENGTH) {
+        return ASSEMBLE_SOURCE_TOO_LARGE;
+    }
+    previousText.swap(text);
+    text.assign(source, length);
+
+    bool partial = rescan();
+    hasVersion = true;
+    if (hadScanError) {
+        compiler.reset();
+        return ASSEMBLE_SCAN_ERROR;
+    }
+    if (!compileVersion(partial)) {
+        return ASSEMBLE_COMPILE_ERROR;
+    }
+    return ASSEMBLE_OK;
+}
+
+typedef struct Watcher {
+    const char *path;
+    const char *outfile;
+    IncrementalAssembler assembler;
+    std::vector<char> rom; // as it is on disk
+} Watcher;
+
+// Only the bytes between the first and last difference are written, unless
+// the file was deleted or cut short since, which took the others with it.
+static bool updateRom(const char *path, const std::vector<char> &old,
+                      const Output &rom, size_t *first, size_t *last) {
+    *first = 0;
+    *last = rom.length;
+    if (strcmp(path, "-") == 0 || old.empty())
+        return writeRom(path, rom.data, rom.length);
+
+    int fd = open(path, O_WRONLY | O_CREAT, 0644);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < old.size()) {
+        close(fd);
+        return writeRom(path, rom.data, rom.length);
+    }
+
+    size_t shorter = old.size() < rom.length ? old.size() : rom.length;
+    while (*first < shorter && old[*first] == rom.data[*first])
+        (*first)++;
+    if (old.size() == rom.length) {
+        while (*last > *first && old[*last - 1] == rom.data[*last - 1])
+            (*last)--;
+        if (*first == *last)
+            return close(fd) == 0;
+    }
+    bool ok = pwrite(fd, rom.data + *first, *last - *first, *first) ==
+                  (ssize_t)(*last - *first) &&
+              ftruncate(fd, rom.length) == 0;
+    return close(fd) == 0 && ok;
+}
+
+static void update(Watcher *w) {
+    auto begin = std::chrono::steady_clock::now();
+    IncrementalAssembler *assembler = &w->assembler;
+    SourceFile source;
+    if (!openSource(w->path, &source)) {
+        fprintf(stderr, "Could not read file \"%s\".\n", w->path);
+        return;
+    }
+    AssembleStatus status = assembler->assemble(source.data, source.length);
+    closeSource(&source);
+    if (status == ASSEMBLE_SOURCE_TOO_LARGE) {
+        fprintf(stderr, "File \"%s\" is too large.\n", w->path);
+        return;
+    }
+    if (status != ASSEMBLE_OK) {
+        assembler->diagnostics.print(stderr);
+        fprintf(stderr, status == ASSEMBLE_SCAN_ERROR ? "Scanning failed.\n"
+                                                      : "Compiling failed.\n");
+        return;
+    }
+
+    size_t first, last;
+    const Output &output = assembler->output;
+    if (!updateRom(w->outfile, w->rom, output, &first, &last)) {
+        fprintf(stderr, "Could not write file \"%s\".\n", w->outfile);
+        w->rom.clear();
+        return;
+    }
+    w->rom.assign(output.data, output.data + output.length);
+    double micros = std::chrono::duration<double, std::micro>(
+                        std::chrono::steady_clock::now() - begin)
+                        .count();
+    fprintf(stderr,
+            "%s: scanned bytes %zu-%zu, wrote ROM bytes %zu-%zu in %.0f us\n",
+            w->path, assembler->scannedBegin, assembler->scannedEnd, first,
+            last, micros);
+}
+
+bool watch(const char *path, const char *outfile) {
+    std::string directory = path;
+    size_t slash = directory.rfind('/');
+    std::string name = slash == std::string::npos
+                           ? directory
+                           : directory.substr(slash + 1);
+    directory = slash == std::string::npos ? "." : directory.substr(0, slash);
+
+    // editors often save by renaming a new file over the old one, so the
+    // directory is watched rather than the file
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0 || inotify_add_watch(fd, directory.c_str(),
+                                    IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        return false;
+
+    auto w = std::make_unique<Watcher>();
+    w->path = path;
+    w->outfile = outfile;
+    update(w.get());
+
+    alignas(inotify_event) char events[4096];
+    while (true) {
+        ssize_t count = read(fd, events, sizeof(events));
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            close(fd);
+            return false;
+        }
+        bool changed = false;
+        for (char *at = events; at < events + count;) {
+            inotify_event *event = (inotify_event *)at;
+            if (event->len > 0 && name == event->name)
+                changed = true;
+            at += sizeof(inotify_event) + event->len;
+        }
+        if (changed)
+            update(w.get());
+    }
+}
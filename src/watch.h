@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+#include <stddef.h>
+#include <string>
+
+#include "arena.h"
+#include "assembler.h"
+#include "diagnostics.h"
+#include "token.h"
+
+// an arena that holds more than this many times what a full scan left in
+// it, plus the slack, is reset and the source scanned again from scratch
+#define ARENA_GROWTH_LIMIT 4
+#define ARENA_SLACK (64 * 1024)
+
+class Compiler;
+struct ScanState;
+
+// The incremental assembly behind watch(), fed one version of a source
+// after the other. Only the lines that changed since the last version are
+// scanned again and compilation continues from the first of them (see
+// Compiler::recompile()). Any error means starting over on the next one.
+class IncrementalAssembler {
+  public:
+    IncrementalAssembler();
+    ~IncrementalAssembler();
+    IncrementalAssembler(const IncrementalAssembler &) = delete;
+    IncrementalAssembler &operator=(const IncrementalAssembler &) = delete;
+
+    // the ROM goes to output, which stays valid until the next call
+    AssembleStatus assemble(const char *source, size_t length);
+
+    Output output;
+    Diagnostics diagnostics;
+    size_t scannedBegin; // the bytes scanned again for the last version
+    size_t scannedEnd;
+
+  private:
+    std::string text;
+    std::string previousText;
+    Arena arena;
+    std::unique_ptr<ScanState> scan;
+    size_t freshUsed; // of the arena right after the last full scan
+    bool hadScanError;
+    bool hasVersion;
+    int firstScanned; // index of the first token scanned for this version
+
+    Arena compilerArena;
+    std::unique_ptr<Compiler> compiler; // of the last error free version
+
+    bool scanRange(size_t begin, size_t end, TokenList *tokens);
+    bool arenaOutgrown();
+    bool rescan();
+    bool compileVersion(bool partial);
+};
+
+// Assembles path into outfile, then again every time path is saved, until
+// the process is killed. Only the lines that changed since the last version
+// are scanned again and only the ROM bytes that changed are written. Returns
+// false if the file can not be watched.
+bool watch(const char *path, const char *outfile);
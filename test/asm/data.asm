@@ -0,0 +1,15 @@
+ROWS = $3C
+
+; address 200
+LD I, sprite
+; address 202
+DRW V0, V1, $3
+
+; addresses 204 and 205
+.db $AA, ROWS
+; addresses 206 to 209
+.dw $00FF, %1000000000000001
+
+; address 20A, after the odd byte
+sprite:
+.db %11110000, $90, $F0
@@ -0,0 +1,12 @@
+; exports only matter to objects, a ROM is the same without them
+.export start, sprite
+
+; address 200
+start:
+LD I, sprite
+; address 202
+JP start
+
+; addresses 204 and 205
+sprite:
+.db $F0, $90
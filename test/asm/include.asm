@@ -0,0 +1,8 @@
+; address 200
+CALL drawSprite
+
+; addresses 202 to 206
+.include "../inc/sprite.inc"
+
+; address 208
+JP drawSprite
@@ -3,4 +3,4 @@ JP testone
 
 ; address 202
 testone:
-JP $200
+JP $200 ; back to the start
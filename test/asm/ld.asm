@@ -6,3 +6,8 @@ LD V0, VAL
 LD V0, V1
 LD I, $123
 LD I, ADDR
+LD V1, $FF
+LD V2, %00000011
+LD I, sprite
+sprite:
+CLS
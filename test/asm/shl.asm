@@ -1 +1,2 @@
 SHL V0
+SHL V0, V1
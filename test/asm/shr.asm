@@ -1 +1,2 @@
 SHR V0
+SHR V0, V1
@@ -0,0 +1,3 @@
+CLS
+; only a register can be added to I
+ADD I, $12
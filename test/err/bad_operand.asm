@@ -0,0 +1,3 @@
+CLS
+; a byte is at most $FF
+LD V0, $1FF
@@ -0,0 +1,4 @@
+loop:
+CLS
+loop:
+JP loop
@@ -0,0 +1,3 @@
+CLS
+; exports have to name labels
+.export nothere
@@ -0,0 +1,3 @@
+CLS
+; the error is reported in the included file
+.include "broken.inc"
@@ -0,0 +1,2 @@
+CLS
+LD V0 V1
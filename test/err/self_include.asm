@@ -0,0 +1,2 @@
+CLS
+.include "self_include.asm"
@@ -0,0 +1,226 @@
+; 3584 bytes fill the ROM, the CLS after them does not fit
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+.dw $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0, $00E0
+CLS
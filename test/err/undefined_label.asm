@@ -0,0 +1,3 @@
+start:
+CLS
+JP nowhere
@@ -0,0 +1,3 @@
+CLS
+; there is no such file next to this one
+.include "nowhere.inc"
@@ -0,0 +1,13 @@
+; linked first, from address 200
+.export start
+
+; address 200, drawSprite comes from sprites.asm
+start:
+CALL drawSprite
+; address 202, a local label moves with the module
+JP loop
+; address 204
+loop:
+LD I, sprite
+; address 206
+JP start
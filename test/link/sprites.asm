@@ -0,0 +1,14 @@
+; linked after main.asm, from address 208
+.export drawSprite, sprite
+
+; address 208
+drawSprite:
+LD I, sprite
+; address 20A
+DRW V0, V1, $2
+; address 20C, start comes from main.asm
+JP start
+
+; addresses 20E and 20F
+sprite:
+.db $F0, $90
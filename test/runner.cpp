@@ -0,0 +1,1142 @@
+// Assembles every test/asm/NAME.asm in memory, plain and pipelined, and
+// compares the ROM with test/bin/NAME.bin byte for byte, on a pool of
+// threads:
+//   test_runner.x [-j threads] [-g generated] [-v] [test directory]
+// Generated cases come from the benchmark corpus (see bench/corpus.h) and
+// have no golden file, instead plain, pipelined and object plus link
+// assembly have to agree on them. Every one of the 65536 words has to come
+// back from disassembling and assembling it again (see disassembler.h).
+// A batch built from a manifest of all golden cases has to write the same
+// ROMs and report the source it is missing. Generated programs edited line
+// by line have to give the same result through the incremental assembler
+// of --watch as assembled afresh. The modules in test/link have to link to
+// test/link/rom.bin, and fail to link with one missing or one twice.
+// Objects with relocations outside their code have to be rejected. Every
+// test/err/NAME.asm has to fail and print test/err/NAME.txt, as ch8asm does
+// on standard error, with paths relative to test/err, plain and pipelined.
+// Sources large enough to be scanned in chunks and emitted in parallel have
+// to give the same ROM and diagnostics on one thread and on several. A
+// cached assembly has to go stale when one of its includes changes or turns
+// up, and a server has to follow includes next to the source while another
+// client idles.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../bench/corpus.h"
+#include "../src/assembler.h"
+#include "../src/batch.h"
+#include "../src/bytes.h"
+#include "../src/cache.h"
+#include "../src/diagnostics.h"
+#include "../src/disassembler.h"
+#include "../src/io.h"
+#include "../src/object.h"
+#include "../src/server.h"
+#include "../src/watch.h"
+
+// rows of a hex diff shown before the rest is cut off
+#define MAX_DIFF_ROWS 8
+// bytes per row, as four instructions
+#define DIFF_ROW 8
+// words that failed to round trip shown per case
+#define MAX_OPCODE_REPORTS 4
+// versions of each program an incremental case goes through
+#define INCREMENTAL_EDITS 200
+// labels of a parallel case, three tokens each, which puts it over both
+// PARALLEL_SCAN_THRESHOLD and PARALLEL_EMIT_THRESHOLD
+#define PARALLEL_LABELS 100000
+// threads of the parallel side of a parallel case
+#define PARALLEL_THREADS 4
+
+typedef enum {
+    CASE_GOLDEN,
+    CASE_GENERATED,
+    CASE_OPCODES, // the 4096 words starting with the nibble in seed
+    CASE_BATCH,   // every golden case in path through runBatch()
+    CASE_INCREMENTAL,
+    CASE_LINK,   // the modules in path
+    CASE_OBJECT, // decoding broken objects
+    CASE_ERROR,  // a source in path that has to fail
+    CASE_CACHE,
+    CASE_SERVER,
+    CASE_PARALLEL, // errors planted as seed says, 0 for none
+} CaseKind;
+
+typedef struct {
+    std::string name;
+    CaseKind kind;
+    std::string path; // of the source of a golden or error case
+    unsigned seed;
+    std::vector<char> expected; // the ROM, or what an error case prints
+    bool passed;
+    std::string report; // why it failed
+} TestCase;
+
+static bool readFile(const std::string &path, std::string *text) {
+    SourceFile file;
+    if (!openSource(path.c_str(), &file))
+        return false;
+    text->assign(file.data, file.length);
+    closeSource(&file);
+    return true;
+}
+
+static void appendf(std::string *text, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static void appendf(std::string *text, const char *format, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    *text += line;
+}
+
+static void appendRow(std::string *text, const std::vector<char> &bytes,
+                      size_t row) {
+    for (size_t i = row; i < row + DIFF_ROW; i += 2) {
+        if (i + 1 < bytes.size())
+            appendf(text, " %02x%02x", (uint8_t)bytes[i],
+                    (uint8_t)bytes[i + 1]);
+        else if (i < bytes.size())
+            appendf(text, " %02x  ", (uint8_t)bytes[i]);
+        else
+            *text += "     ";
+    }
+}
+
+// the rows that differ, addressed as loaded at 0x200
+static void hexDiff(std::string *report, const char *left,
+                    const std::vector<char> &expected, const char *right,
+                    const std::vector<char> &actual) {
+    appendf(report, "  %zu bytes %s, %zu bytes %s\n", expected.size(), left,
+            actual.size(), right);
+    appendf(report, "  addr  %-20s  %s\n", left, right);
+    size_t length = std::max(expected.size(), actual.size());
+    int rows = 0;
+    for (size_t row = 0; row < length; row += DIFF_ROW) {
+        bool same = true;
+        for (size_t i = row; i < row + DIFF_ROW; i++) {
+            bool inExpected = i < expected.size();
+            bool inActual = i < actual.size();
+            if (inExpected != inActual ||
+                (inExpected && expected[i] != actual[i]))
+                same = false;
+        }
+        if (same)
+            continue;
+        if (rows++ == MAX_DIFF_ROWS) {
+            *report += "  ...\n";
+            break;
+        }
+        appendf(report, "  %04zx ", 0x200 + row);
+        appendRow(report, expected, row);
+        *report += "  ";
+        appendRow(report, actual, row);
+        report->erase(report->find_last_not_of(' ') + 1);
+        *report += "\n";
+    }
+}
+
+static void appendDiagnostics(std::string *report,
+                              const Diagnostics &diagnostics) {
+    for (const Diagnostic &diagnostic : diagnostics.list) {
+        if (diagnostic.file.empty())
+            appendf(report, "  [line %d] %s\n", diagnostic.line,
+                    diagnostic.message.c_str());
+        else
+            appendf(report, "  [%s line %d] %s\n", diagnostic.file.c_str(),
+                    diagnostic.line, diagnostic.message.c_str());
+    }
+}
+
+static void appendIndented(std::string *report, const std::string &text) {
+    for (size_t begin = 0; begin < text.size();) {
+        size_t end = text.find('\n', begin);
+        end = end == std::string::npos ? text.size() : end + 1;
+        *report += "    " + text.substr(begin, end - begin);
+        begin = end;
+    }
+    if (!text.empty() && text.back() != '\n')
+        *report += "\n";
+}
+
+// the ROM of an assembly that has to succeed, false after reporting why not
+static bool assembleRom(Assembler *assembler, const std::string &source,
+                        std::vector<char> *rom, std::string *report) {
+    Output output;
+    Diagnostics diagnostics;
+    AssembleStatus status = assembler->assemble(source.data(), source.size(),
+                                                &output, &diagnostics);
+    if (status != ASSEMBLE_OK) {
+        *report += "  assembling failed\n";
+        appendDiagnostics(report, diagnostics);
+        return false;
+    }
+    rom->assign(output.data, output.data + output.length);
+    return true;
+}
+
+static bool linkRom(Assembler *assembler, const std::string &source,
+                    std::vector<char> *rom, std::string *report) {
+    ObjectFile object;
+    Diagnostics diagnostics;
+    AssembleStatus status = assembler->assembleObject(
+        source.data(), source.size(), &object, &diagnostics);
+    if (status != ASSEMBLE_OK ||
+        !link({object}, {assembler->path}, rom, &diagnostics)) {
+        *report += "  assembling and linking an object failed\n";
+        appendDiagnostics(report, diagnostics);
+        return false;
+    }
+    return true;
+}
+
+static void runGolden(Assembler *assembler, Assembler *pipelined,
+                      TestCase *test) {
+    std::string source;
+    std::vector<char> rom, streamed;
+    if (!test->report.empty()) {
+        return; // without a golden file
+    } else if (!readFile(test->path, &source)) {
+        test->report = "  could not read the source\n";
+        return;
+    }
+    assembler->path = test->path;
+    pipelined->path = test->path;
+    if (!assembleRom(assembler, source, &rom, &test->report) ||
+        !assembleRom(pipelined, source, &streamed, &test->report))
+        return;
+    if (rom != test->expected) {
+        hexDiff(&test->report, "expected", test->expected, "assembled",
+                rom);
+        return;
+    } else if (streamed != test->expected) {
+        hexDiff(&test->report, "expected", test->expected, "pipelined",
+                streamed);
+        return;
+    }
+    test->passed = true;
+}
+
+static void runGenerated(Assembler *assembler, Assembler *pipelined,
+                         TestCase *test) {
+    CorpusOptions options = defaultCorpus();
+    options.size = 256 + test->seed * 7919 % 4096;
+    options.seed = test->seed;
+    std::string source = generateCorpus(options);
+    std::vector<char> plain, streamed, linked;
+    assembler->path = test->name;
+    pipelined->path = test->name;
+    if (!assembleRom(assembler, source, &plain, &test->report) ||
+        !assembleRom(pipelined, source, &streamed, &test->report) ||
+        !linkRom(assembler, source, &linked, &test->report))
+        return;
+    if (streamed != plain) {
+        hexDiff(&test->report, "plain", plain, "pipelined", streamed);
+    } else if (linked != plain) {
+        hexDiff(&test->report, "plain", plain, "linked", linked);
+    } else {
+        test->passed = true;
+    }
+}
+
+static void runOpcodes(Assembler *assembler, TestCase *test) {
+    int failed = 0;
+    std::string source;
+    std::vector<char> rom;
+    assembler->path = test->name;
+    for (uint32_t low = 0; low < 0x1000; low++) {
+        uint16_t opcode = test->seed << 12 | low;
+        std::vector<char> word = {(char)(opcode >> 8), (char)opcode};
+        disassemble(word.data(), word.size(), &source);
+        std::string report;
+        if (assembleRom(assembler, source, &rom, &report) && rom == word)
+            continue;
+        if (failed++ < MAX_OPCODE_REPORTS) {
+            appendf(&test->report, "  %04x disassembles to\n", opcode);
+            test->report += source;
+            test->report += report;
+        }
+    }
+    if (failed > MAX_OPCODE_REPORTS)
+        appendf(&test->report, "  and %d more\n",
+                failed - MAX_OPCODE_REPORTS);
+    test->passed = failed == 0;
+}
+
+// deletes, copies or replaces a line, or leaves the text as it is
+static void editLines(std::vector<std::string> *lines, unsigned *seed) {
+    size_t count = lines->size();
+    size_t at = count > 0 ? rand_r(seed) % count : 0;
+    std::string copy = count > 0 ? (*lines)[rand_r(seed) % count] : "CLS\n";
+    switch (rand_r(seed) % 5) {
+        case 0:
+            if (count > 1)
+                lines->erase(lines->begin() + at);
+            break;
+        case 1:
+            lines->insert(lines->begin() + at, copy);
+            break;
+        case 2:
+            (*lines)[at] = copy;
+            break;
+        case 3:
+            lines->push_back(copy);
+            break;
+    }
+}
+
+static std::string joinLines(const std::vector<std::string> &lines) {
+    std::string text;
+    for (const std::string &line : lines) {
+        text += line;
+    }
+    return text;
+}
+
+// Edits that define a label twice or overflow the ROM fail both ways, the
+// versions after them have to recover the same way.
+static void runIncremental(Assembler *assembler, TestCase *test) {
+    CorpusOptions options = defaultCorpus();
+    options.size = 512 + test->seed * 7919 % 2048;
+    options.seed = 5000 + test->seed;
+    std::string source = generateCorpus(options);
+    std::vector<std::string> lines;
+    for (size_t begin = 0; begin < source.size();) {
+        size_t end = source.find('\n', begin);
+        end = end == std::string::npos ? source.size() : end + 1;
+        lines.push_back(source.substr(begin, end - begin));
+        begin = end;
+    }
+
+    IncrementalAssembler incremental;
+    assembler->path = test->name;
+    unsigned seed = test->seed;
+    for (int edit = 0; edit <= INCREMENTAL_EDITS; edit++) {
+        if (edit > 0)
+            editLines(&lines, &seed);
+        std::string text = joinLines(lines);
+        Output output;
+        Diagnostics diagnostics;
+        AssembleStatus expected = assembler->assemble(
+            text.data(), text.size(), &output, &diagnostics);
+        AssembleStatus status = incremental.assemble(text.data(), text.size());
+        std::vector<char> fresh(output.data, output.data + output.length);
+        std::vector<char> rom(incremental.output.data,
+                              incremental.output.data +
+                                  incremental.output.length);
+        if (status != expected) {
+            appendf(&test->report, "  version %d: status %d instead of %d\n",
+                    edit, status, expected);
+            appendDiagnostics(&test->report, incremental.diagnostics);
+            return;
+        } else if (status == ASSEMBLE_OK && rom != fresh) {
+            appendf(&test->report, "  version %d:\n", edit);
+            hexDiff(&test->report, "afresh", fresh, "incremental", rom);
+            return;
+        }
+    }
+    test->passed = true;
+}
+
+// the module at path as an object, and encoded and decoded again
+static bool assembleModule(Assembler *assembler, const std::string &path,
+                           ObjectFile *object, std::string *report) {
+    std::string source;
+    Diagnostics diagnostics;
+    std::vector<char> bytes;
+    if (!readFile(path, &source)) {
+        *report += "  could not read " + path + "\n";
+        return false;
+    }
+    assembler->path = path;
+    if (assembler->assembleObject(source.data(), source.size(), object,
+                                  &diagnostics) != ASSEMBLE_OK) {
+        *report += "  assembling " + path + " failed\n";
+        appendDiagnostics(report, diagnostics);
+        return false;
+    }
+    encodeObject(*object, &bytes);
+    if (!decodeObject(bytes.data(), bytes.size(), object)) {
+        *report += "  the object of " + path + " does not decode\n";
+        return false;
+    }
+    return true;
+}
+
+// the first diagnostic has to be message, in file on line
+static void expectDiagnostic(const Diagnostics &diagnostics,
+                             const std::string &file, int line,
+                             const std::string &message,
+                             std::string *report) {
+    if (diagnostics.list.empty()) {
+        *report += "  no \"" + message + "\"\n";
+    } else if (diagnostics.list[0].file != file ||
+               diagnostics.list[0].line != line ||
+               diagnostics.list[0].message != message) {
+        appendf(report, "  expected line %d: %s\n", line, message.c_str());
+        appendDiagnostics(report, diagnostics);
+    }
+}
+
+static void runLink(Assembler *assembler, TestCase *test) {
+    std::string main = test->path + "/main.asm";
+    std::string sprites = test->path + "/sprites.asm";
+    std::string rom;
+    ObjectFile first, second;
+    if (!readFile(test->path + "/rom.bin", &rom)) {
+        test->report = "  no golden file " + test->path + "/rom.bin\n";
+        return;
+    } else if (!assembleModule(assembler, main, &first, &test->report) ||
+               !assembleModule(assembler, sprites, &second, &test->report)) {
+        return;
+    }
+
+    std::vector<char> linked;
+    Diagnostics diagnostics;
+    if (!link({first, second}, {main, sprites}, &linked, &diagnostics)) {
+        test->report += "  linking failed\n";
+        appendDiagnostics(&test->report, diagnostics);
+    } else if (linked != std::vector<char>(rom.begin(), rom.end())) {
+        hexDiff(&test->report, "expected", {rom.begin(), rom.end()},
+                "linked", linked);
+    }
+
+    diagnostics.clear();
+    if (link({first}, {main}, &linked, &diagnostics))
+        test->report += "  linked without sprites.asm\n";
+    expectDiagnostic(diagnostics, main, 6,
+                     "Label 'drawSprite' does not exist.", &test->report);
+    diagnostics.clear();
+    if (link({first, second, second}, {main, sprites, sprites}, &linked,
+             &diagnostics))
+        test->report += "  linked with sprites.asm twice\n";
+    expectDiagnostic(diagnostics, sprites, 2,
+                     "Label 'drawSprite' is exported more than once.",
+                     &test->report);
+
+    const char *source = "CLS\n.export nowhere\n";
+    diagnostics.clear();
+    assembler->path = test->name;
+    if (assembler->assembleObject(source, strlen(source), &first,
+                                  &diagnostics) == ASSEMBLE_OK)
+        test->report += "  exported a label that does not exist\n";
+    expectDiagnostic(diagnostics, "", 2, "Label 'nowhere' does not exist.",
+                     &test->report);
+    test->passed = test->report.empty();
+}
+
+// A relocation has to leave room for the two bytes it patches, even at
+// offsets where adding 2 wraps around. Cutting an object short anywhere
+// has to be noticed too.
+static void runObject(TestCase *test) {
+    ObjectFile object;
+    std::vector<char> bytes;
+    object.code = {0x12, 0x00, 0x22, 0x00};
+    object.files = {""};
+    object.relocations = {{0, LOCAL_LABEL, {0, 1}}};
+    encodeObject(object, &bytes);
+    // the relocation is the last 16 bytes, its offset first
+    size_t at = bytes.size() - 16;
+    const uint32_t offsets[] = {2, 3, 4, 0xFFFFFFFE, 0xFFFFFFFF};
+    for (uint32_t offset : offsets) {
+        std::vector<char> hostile = bytes;
+        for (int i = 0; i < 4; i++) {
+            hostile[at + i] = (char)(offset >> (i * 8));
+        }
+        bool accepted = decodeObject(hostile.data(), hostile.size(), &object);
+        if (accepted != (offset == 2))
+            appendf(&test->report, "  relocation at %u was %s\n", offset,
+                    accepted ? "accepted" : "rejected");
+    }
+    for (size_t length = 0; length < bytes.size(); length++) {
+        if (decodeObject(bytes.data(), length, &object))
+            appendf(&test->report, "  accepted the first %zu of %zu bytes\n",
+                    length, bytes.size());
+    }
+    test->passed = test->report.empty();
+}
+
+// What ch8asm prints on standard error when the source fails, false after
+// reporting why it could not be collected. Paths in diagnostics start with
+// directory, which is left out.
+static bool printFailure(Assembler *assembler, const std::string &source,
+                         const std::string &directory, std::string *printed,
+                         std::string *report) {
+    Output output;
+    Diagnostics diagnostics;
+    AssembleStatus status = assembler->assemble(source.data(), source.size(),
+                                                &output, &diagnostics);
+    if (status == ASSEMBLE_OK) {
+        *report += "  assembled without errors\n";
+        return false;
+    }
+    char *text = nullptr;
+    size_t length = 0;
+    FILE *stream = open_memstream(&text, &length);
+    if (stream == nullptr) {
+        *report += "  could not collect the diagnostics\n";
+        return false;
+    }
+    diagnostics.print(stream);
+    fputs(status == ASSEMBLE_SCAN_ERROR ? "Scanning failed.\n"
+                                        : "Compiling failed.\n",
+          stream);
+    fclose(stream);
+    printed->assign(text, length);
+    free(text);
+    for (size_t at; !directory.empty() &&
+                    (at = printed->find(directory)) != std::string::npos;) {
+        printed->erase(at, directory.size());
+    }
+    return true;
+}
+
+// plain and pipelined have to print the same
+static void runError(Assembler *assembler, Assembler *pipelined,
+                     TestCase *test) {
+    std::string source;
+    if (!test->report.empty()) {
+        return; // without an expected file
+    } else if (!readFile(test->path, &source)) {
+        test->report = "  could not read the source\n";
+        return;
+    }
+    std::string directory = test->path.substr(0, test->path.rfind('/') + 1);
+    std::string expected(test->expected.begin(), test->expected.end());
+    Assembler *assemblers[] = {assembler, pipelined};
+    for (Assembler *a : assemblers) {
+        std::string printed;
+        a->path = test->path;
+        if (!printFailure(a, source, directory, &printed, &test->report)) {
+            test->report += a->pipeline ? "  (pipelined)\n" : "";
+            return;
+        } else if (printed != expected) {
+            test->report = a->pipeline ? "  pipelined, expected\n"
+                                       : "  expected\n";
+            appendIndented(&test->report, expected);
+            test->report += "  printed\n";
+            appendIndented(&test->report, printed);
+            return;
+        }
+    }
+    test->passed = true;
+}
+
+// Mostly labels and comments, so it has far more tokens than a ROM has room
+// for instructions. Every 64th line is an instruction that refers to labels
+// before and after it, across the chunks. An odd seed plants a bad operand
+// half way, one above 1 a missing label three quarters of the way.
+static std::string parallelSource(unsigned seed) {
+    std::string source;
+    char name[32], target[32], line[128];
+    for (int i = 0; i < PARALLEL_LABELS; i++) {
+        snprintf(line, sizeof(line), "%s: ; padding to split the source\n",
+                 corpusName(name, "p", i));
+        source += line;
+        if (seed % 2 == 1 && i == PARALLEL_LABELS / 2)
+            source += "LD V0, $1FF\n";
+        if (seed > 1 && i == PARALLEL_LABELS / 4 * 3)
+            source += "JP nowhere\n";
+        if (i % 64 != 63)
+            continue;
+        int other = i % 128 == 63 ? i + 1000 : i - 1000;
+        corpusName(target, "p", other < 0 ? 0 : other % PARALLEL_LABELS);
+        switch (i / 64 % 4) {
+            case 0:
+                snprintf(line, sizeof(line), "JP %s\n", target);
+                break;
+            case 1:
+                snprintf(line, sizeof(line), "CALL %s\n", target);
+                break;
+            case 2:
+                snprintf(line, sizeof(line), "LD I, %s\n", target);
+                break;
+            default:
+                snprintf(line, sizeof(line), "DRW V0, V1, $%X\n", i % 16);
+        }
+        source += line;
+    }
+    return source;
+}
+
+static bool sameDiagnostics(const Diagnostics &a, const Diagnostics &b) {
+    if (a.list.size() != b.list.size())
+        return false;
+    for (size_t i = 0; i < a.list.size(); i++) {
+        if (a.list[i].line != b.list[i].line ||
+            a.list[i].file != b.list[i].file ||
+            a.list[i].message != b.list[i].message)
+            return false;
+    }
+    return true;
+}
+
+static void runParallel(Assembler *assembler, TestCase *test) {
+    std::string source = parallelSource(test->seed);
+    Assembler parallel(PARALLEL_THREADS);
+    Output serialOutput, parallelOutput;
+    Diagnostics serialDiagnostics, parallelDiagnostics;
+    assembler->path = test->name;
+    parallel.path = test->name;
+    AssembleStatus serial = assembler->assemble(
+        source.data(), source.size(), &serialOutput, &serialDiagnostics);
+    AssembleStatus status = parallel.assemble(
+        source.data(), source.size(), &parallelOutput, &parallelDiagnostics);
+    std::vector<char> one(serialOutput.data,
+                          serialOutput.data + serialOutput.length);
+    std::vector<char> many(parallelOutput.data,
+                           parallelOutput.data + parallelOutput.length);
+    if ((serial == ASSEMBLE_OK) != (test->seed == 0)) {
+        appendf(&test->report, "  status %d on one thread\n", serial);
+        appendDiagnostics(&test->report, serialDiagnostics);
+    } else if (status != serial) {
+        appendf(&test->report, "  status %d on %d threads, %d on one\n",
+                status, PARALLEL_THREADS, serial);
+    } else if (!sameDiagnostics(serialDiagnostics, parallelDiagnostics)) {
+        test->report += "  one thread reported\n";
+        appendDiagnostics(&test->report, serialDiagnostics);
+        appendf(&test->report, "  %d threads reported\n", PARALLEL_THREADS);
+        appendDiagnostics(&test->report, parallelDiagnostics);
+    } else if (status == ASSEMBLE_OK && many != one) {
+        hexDiff(&test->report, "one thread", one, "threads", many);
+    }
+    test->passed = test->report.empty();
+}
+
+static bool findCases(const std::string &directory,
+                      std::vector<TestCase> *tests);
+
+// a fresh directory for the files of one case, see removeScratch()
+static bool makeScratch(std::string *directory) {
+    const char *tmp = getenv("TMPDIR");
+    std::string name = tmp != nullptr ? tmp : "/tmp";
+    name += "/ch8test.XXXXXX";
+    if (mkdtemp(&name[0]) == nullptr)
+        return false;
+    *directory = name;
+    return true;
+}
+
+// the scratch directory and everything in it
+static void removeScratch(const std::string &directory) {
+    DIR *dir = opendir(directory.c_str());
+    if (dir != nullptr) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            std::string path = directory + "/" + entry->d_name;
+            if (strcmp(entry->d_name, ".") == 0 ||
+                strcmp(entry->d_name, "..") == 0)
+                continue;
+            if (unlink(path.c_str()) != 0 && errno == EISDIR)
+                removeScratch(path);
+        }
+        closedir(dir);
+    }
+    rmdir(directory.c_str());
+}
+
+static bool writeText(const std::string &path, const char *text) {
+    return writeRom(path.c_str(), text, strlen(text));
+}
+
+// Assembles the source at path the way ch8asm --cache does, *hit tells
+// whether the result came from the cache.
+static AssembleStatus assembleCached(AssemblyCache *cache,
+                                     Assembler *assembler,
+                                     const std::string &path,
+                                     std::vector<char> *rom,
+                                     Diagnostics *diagnostics, bool *hit) {
+    std::string source;
+    Output output;
+    AssembleStatus status;
+    std::vector<Dependency> dependencies;
+    diagnostics->clear();
+    rom->clear();
+    if (!readFile(path, &source))
+        return ASSEMBLE_SOURCE_TOO_LARGE;
+    *hit = cache->lookup(path.c_str(), source.data(), source.size(), &status,
+                         &output, diagnostics, &dependencies);
+    if (!*hit) {
+        assembler->path = path;
+        status = assembler->assemble(source.data(), source.size(), &output,
+                                     diagnostics);
+        cache->store(path.c_str(), source.data(), source.size(), status,
+                     output, *diagnostics, assembler->dependencies);
+    }
+    rom->assign(output.data, output.data + output.length);
+    return status;
+}
+
+// One step of the cache case: the ROM main.asm has to assemble to with the
+// lib.inc of that step, empty when it has to fail, and whether it has to
+// come from the cache.
+typedef struct {
+    const char *library; // nullptr when there is no lib.inc
+    std::vector<char> rom;
+    bool hit;
+} CacheStep;
+
+static void runCache(Assembler *assembler, TestCase *test) {
+    std::string scratch;
+    if (!makeScratch(&scratch)) {
+        test->report = "  could not make a scratch directory\n";
+        return;
+    }
+    AssemblyCache cache((scratch + "/cache").c_str(), 1 << 20);
+    std::string main = scratch + "/main.asm";
+    std::string library = scratch + "/lib.inc";
+    const CacheStep steps[] = {
+        {nullptr, {}, false},
+        {nullptr, {}, false}, // a failed include is never served
+        {"RET\n", {0x00, (char)0xE0, 0x00, (char)0xEE}, false},
+        {"RET\n", {0x00, (char)0xE0, 0x00, (char)0xEE}, true},
+        {"LD V1, $22\n", {0x00, (char)0xE0, 0x61, 0x22}, false},
+        {"LD V1, $22\n", {0x00, (char)0xE0, 0x61, 0x22}, true},
+    };
+    if (!writeText(main, "CLS\n.include \"lib.inc\"\n"))
+        test->report = "  could not write main.asm\n";
+    for (size_t i = 0; i < sizeof(steps) / sizeof(*steps); i++) {
+        const CacheStep &step = steps[i];
+        if (step.library == nullptr)
+            unlink(library.c_str());
+        else if (!writeText(library, step.library))
+            test->report = "  could not write lib.inc\n";
+        std::vector<char> rom;
+        Diagnostics diagnostics;
+        bool hit;
+        AssembleStatus status = assembleCached(&cache, assembler, main, &rom,
+                                               &diagnostics, &hit);
+        if (step.rom.empty() != (status != ASSEMBLE_OK)) {
+            appendf(&test->report, "  step %zu: status %d\n", i, status);
+            appendDiagnostics(&test->report, diagnostics);
+        } else if (rom != step.rom) {
+            appendf(&test->report, "  step %zu:\n", i);
+            hexDiff(&test->report, "expected", step.rom, "cached", rom);
+        }
+        if (hit != step.hit)
+            appendf(&test->report, "  step %zu: %s the cache\n", i,
+                    hit ? "served from" : "not served from");
+    }
+
+    // a batch goes by the same entries
+    std::vector<BatchJob> jobs = {batchJob(main.c_str())};
+    std::string rom;
+    char *log = nullptr;
+    size_t logLength = 0;
+    FILE *logFile = open_memstream(&log, &logLength);
+    writeText(library, "RET\n");
+    int code = logFile == nullptr ? -1
+                                  : runBatch(jobs, 1, &cache,
+                                             {false, false, false, false,
+                                              logFile});
+    if (logFile != nullptr)
+        fclose(logFile);
+    if (code != 0 || !readFile(scratch + "/main.bin", &rom) ||
+        rom != std::string("\x00\xE0\x00\xEE", 4)) {
+        test->report += "  the batch did not pick up the changed lib.inc\n";
+        test->report += log != nullptr ? log : "";
+    }
+    free(log);
+
+    // failures without includes are served with their diagnostics
+    std::string plain = scratch + "/plain.asm";
+    writeText(plain, "CLS\nJP nowhere\n");
+    for (int i = 0; i < 2; i++) {
+        std::vector<char> failed;
+        Diagnostics diagnostics;
+        bool hit;
+        AssembleStatus status = assembleCached(&cache, assembler, plain,
+                                               &failed, &diagnostics, &hit);
+        if (status != ASSEMBLE_COMPILE_ERROR || hit != (i == 1))
+            appendf(&test->report, "  plain.asm, run %d: status %d, %s\n",
+                    i + 1, status, hit ? "hit" : "miss");
+        expectDiagnostic(diagnostics, "", 2,
+                         "Label 'nowhere' does not exist.", &test->report);
+    }
+    removeScratch(scratch);
+    test->passed = test->report.empty();
+}
+
+// a connection to the server at path, which may still be starting up
+static int connectRetrying(const std::string &path) {
+    for (int attempt = 0; attempt < 200; attempt++) {
+        int fd = connectServer(path.c_str());
+        if (fd >= 0) {
+            // a server that hangs fails the case instead of the runner
+            timeval timeout = {5, 0};
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            return fd;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return -1;
+}
+
+// A request over MAX_REQUEST_LENGTH is answered without being read and the
+// connection closed.
+static void checkOversized(int fd, std::string *report) {
+    uint8_t header[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+    uint8_t response[64];
+    size_t length = 0;
+    ssize_t count;
+    send(fd, header, 4, MSG_NOSIGNAL);
+    while (length < sizeof(response) &&
+           (count = recv(fd, response + length, sizeof(response) - length,
+                         0)) > 0)
+        length += count;
+    Reader reader = {response, response + length};
+    uint32_t size, dependencies, status;
+    if (!getU32(&reader, &size) || !getU32(&reader, &dependencies) ||
+        !getU32(&reader, &status) || status != ASSEMBLE_SOURCE_TOO_LARGE ||
+        count != 0)
+        *report += "  an oversized request was not refused\n";
+}
+
+// One worker, so the request on the second connection is only answered if
+// the idle first one does not hold it up.
+static void runServer(Assembler *assembler, TestCase *test) {
+    std::string scratch;
+    if (!makeScratch(&scratch)) {
+        test->report = "  could not make a scratch directory\n";
+        return;
+    }
+    std::string main = scratch + "/main.asm";
+    std::string source = "CLS\n.include \"lib.inc\"\n";
+    writeText(main, source.c_str());
+    writeText(scratch + "/lib.inc", "RET\n");
+    // serve() never returns, so neither the thread nor its path end
+    char *path = strdup((scratch + "/socket").c_str());
+    std::thread(serve, path, 1).detach();
+
+    int idle = connectRetrying(path);
+    int fd = connectServer(path);
+    Output output;
+    Diagnostics diagnostics;
+    std::vector<Dependency> dependencies;
+    AssembleStatus status;
+    if (idle < 0 || fd < 0) {
+        test->report = "  could not connect to the server\n";
+    } else if (remoteAssemble(fd, main.c_str(), source.data(), source.size(),
+                              &output, &diagnostics, &dependencies,
+                              &status) != REMOTE_OK) {
+        test->report = "  no answer from the server\n";
+    } else {
+        std::vector<char> rom(output.data, output.data + output.length);
+        std::vector<char> local;
+        assembler->path = main;
+        if (status != ASSEMBLE_OK) {
+            test->report += "  assembling failed\n";
+            appendDiagnostics(&test->report, diagnostics);
+        } else if (!assembleRom(assembler, source, &local, &test->report) ||
+                   rom != local) {
+            hexDiff(&test->report, "local", local, "server", rom);
+        } else if (dependencies.size() != 1 ||
+                   dependencies[0].path != assembler->dependencies[0].path ||
+                   dependencies[0].hash != assembler->dependencies[0].hash) {
+            test->report += "  lib.inc was not reported as included\n";
+        }
+
+        // and again on the same connection
+        const char *failing = "CLS\nJP nowhere\n";
+        diagnostics.clear();
+        if (remoteAssemble(fd, main.c_str(), failing, strlen(failing),
+                           &output, &diagnostics, &dependencies,
+                           &status) != REMOTE_OK ||
+            status != ASSEMBLE_COMPILE_ERROR)
+            test->report += "  a second request failed\n";
+        expectDiagnostic(diagnostics, "", 2,
+                         "Label 'nowhere' does not exist.", &test->report);
+        checkOversized(fd, &test->report);
+    }
+    if (fd >= 0)
+        close(fd);
+    if (idle >= 0)
+        close(idle);
+    removeScratch(scratch);
+    test->passed = test->report.empty();
+}
+
+static void checkBatch(const std::vector<TestCase> &golden,
+                       const std::string &scratch, int code,
+                       const std::string &log, TestCase *test) {
+    std::string missing =
+        "Could not read file \"" + scratch + "/missing.asm\".";
+    if (code != 74)
+        appendf(&test->report, "  exit code %d instead of 74\n", code);
+    if (log.find(missing) == std::string::npos)
+        test->report += "  the missing source was not reported\n";
+    if (access((scratch + "/missing.bin").c_str(), F_OK) == 0)
+        test->report += "  a ROM was written for the missing source\n";
+    for (const TestCase &c : golden) {
+        std::string rom;
+        if (!c.report.empty()) {
+            continue;
+        } else if (!readFile(scratch + "/" + c.name + ".bin", &rom)) {
+            test->report += "  " + c.name + ".bin was not written\n";
+        } else if (std::vector<char>(rom.begin(), rom.end()) != c.expected) {
+            test->report += "  " + c.name + ".bin\n";
+            hexDiff(&test->report, "expected", c.expected, "batch",
+                    std::vector<char>(rom.begin(), rom.end()));
+        }
+    }
+    if (!test->report.empty())
+        test->report += log;
+    test->passed = test->report.empty();
+}
+
+static void runBatchCase(TestCase *test) {
+    std::vector<TestCase> golden;
+    std::string scratch;
+    if (!findCases(test->path, &golden) || !makeScratch(&scratch)) {
+        test->report = "  could not set up the batch\n";
+        return;
+    }
+    std::string manifest = "; every golden case, then one that is missing\n";
+    for (const TestCase &c : golden) {
+        manifest += c.path + " " + scratch + "/" + c.name + ".bin\n";
+    }
+    manifest += scratch + "/missing.asm\n";
+    std::string manifestPath = scratch + "/manifest";
+    std::vector<BatchJob> jobs;
+    char *log = nullptr;
+    size_t logLength = 0;
+    FILE *logFile = open_memstream(&log, &logLength);
+    int code = -1;
+    if (logFile != nullptr &&
+        writeRom(manifestPath.c_str(), manifest.data(), manifest.size()) &&
+        readManifest(manifestPath.c_str(), &jobs)) {
+        code = runBatch(jobs, 2, nullptr,
+                        {false, false, false, false, logFile});
+    }
+    if (logFile != nullptr)
+        fclose(logFile);
+
+    if (jobs.size() != golden.size() + 1)
+        appendf(&test->report, "  %zu jobs in the manifest instead of %zu\n",
+                jobs.size(), golden.size() + 1);
+    else
+        checkBatch(golden, scratch, code, log != nullptr ? log : "", test);
+    free(log);
+    removeScratch(scratch);
+}
+
+static void worker(std::vector<TestCase> *tests, std::atomic<size_t> *next,
+                   IncludeCache *includes) {
+    Assembler assembler;
+    Assembler pipelined;
+    assembler.includes = includes;
+    pipelined.includes = includes;
+    pipelined.pipeline = true;
+    size_t i;
+    while ((i = next->fetch_add(1, std::memory_order_relaxed)) <
+           tests->size()) {
+        TestCase *test = &(*tests)[i];
+        if (test->kind == CASE_GOLDEN)
+            runGolden(&assembler, &pipelined, test);
+        else if (test->kind == CASE_GENERATED)
+            runGenerated(&assembler, &pipelined, test);
+        else if (test->kind == CASE_OPCODES)
+            runOpcodes(&assembler, test);
+        else if (test->kind == CASE_BATCH)
+            runBatchCase(test);
+        else if (test->kind == CASE_INCREMENTAL)
+            runIncremental(&assembler, test);
+        else if (test->kind == CASE_LINK)
+            runLink(&assembler, test);
+        else if (test->kind == CASE_OBJECT)
+            runObject(test);
+        else if (test->kind == CASE_ERROR)
+            runError(&assembler, &pipelined, test);
+        else if (test->kind == CASE_CACHE)
+            runCache(&assembler, test);
+        else if (test->kind == CASE_SERVER)
+            runServer(&assembler, test);
+        else
+            runParallel(&assembler, test);
+    }
+}
+
+// the NAME of every NAME.asm in directory, sorted
+static bool findSources(const std::string &directory,
+                        std::vector<std::string> *names) {
+    DIR *dir = opendir(directory.c_str());
+    if (dir == nullptr)
+        return false;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        size_t length = strlen(entry->d_name);
+        if (length > 4 && strcmp(entry->d_name + length - 4, ".asm") == 0)
+            names->push_back(std::string(entry->d_name, length - 4));
+    }
+    closedir(dir);
+    std::sort(names->begin(), names->end());
+    return true;
+}
+
+// every NAME.asm in directory/asm with its directory/bin/NAME.bin, by name
+static bool findCases(const std::string &directory,
+                      std::vector<TestCase> *tests) {
+    std::vector<std::string> names;
+    if (!findSources(directory + "/asm", &names))
+        return false;
+    for (const std::string &name : names) {
+        TestCase test = {name, CASE_GOLDEN,
+                         directory + "/asm/" + name + ".asm", 0, {}, false,
+                         ""};
+        std::string expected;
+        if (!readFile(directory + "/bin/" + name + ".bin", &expected)) {
+            test.report = "  no golden file " + directory + "/bin/" + name +
+                          ".bin\n";
+        }
+        test.expected.assign(expected.begin(), expected.end());
+        tests->push_back(test);
+    }
+    return true;
+}
+
+// every NAME.asm in directory/err with what it prints in NAME.txt
+static bool findErrorCases(const std::string &directory,
+                           std::vector<TestCase> *tests) {
+    std::vector<std::string> names;
+    if (!findSources(directory + "/err", &names))
+        return false;
+    for (const std::string &name : names) {
+        std::string path = directory + "/err/" + name;
+        TestCase test = {"error " + name, CASE_ERROR, path + ".asm", 0, {},
+                         false, ""};
+        std::string expected;
+        if (!readFile(path + ".txt", &expected))
+            test.report = "  no expected file " + path + ".txt\n";
+        test.expected.assign(expected.begin(), expected.end());
+        tests->push_back(test);
+    }
+    return true;
+}
+
+static void usage() {
+    fprintf(stderr, "Usage: test_runner [-j threads] [-g generated] [-v] "
+                    "[test directory]\n");
+    exit(64);
+}
+
+// a count of at least minimum, anything else is a usage error
+static int parseCount(const char *text, int minimum) {
+    char *end;
+    errno = 0;
+    long count = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || count < minimum ||
+        count > INT_MAX)
+        usage();
+    return count;
+}
+
+int main(int argc, char *argv[]) {
+    int threads = std::thread::hardware_concurrency();
+    int generated = 1000;
+    bool verbose = false;
+    const char *directory = "test";
+    for (int arg = 1; arg < argc; arg++) {
+        if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc) {
+            threads = parseCount(argv[++arg], 1);
+        } else if (strcmp(argv[arg], "-g") == 0 && arg + 1 < argc) {
+            generated = parseCount(argv[++arg], 0);
+        } else if (strcmp(argv[arg], "-v") == 0) {
+            verbose = true;
+        } else if (argv[arg][0] == '-') {
+            usage();
+        } else {
+            directory = argv[arg];
+        }
+    }
+
+    std::vector<TestCase> tests;
+    if (!findCases(directory, &tests)) {
+        fprintf(stderr, "Could not read directory \"%s/asm\".\n", directory);
+        return 74;
+    }
+    size_t golden = tests.size();
+    if (!findErrorCases(directory, &tests)) {
+        fprintf(stderr, "Could not read directory \"%s/err\".\n", directory);
+        return 74;
+    }
+    size_t errors = tests.size() - golden;
+    for (int i = 0; i < generated; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "generated %d", i + 1);
+        tests.push_back(
+            {name, CASE_GENERATED, "", (unsigned)i + 1, {}, false, ""});
+    }
+    for (unsigned nibble = 0; nibble < 16; nibble++) {
+        char name[32];
+        snprintf(name, sizeof(name), "opcodes %xxxx", nibble);
+        tests.push_back({name, CASE_OPCODES, "", nibble, {}, false, ""});
+    }
+
+    tests.push_back({"batch", CASE_BATCH, directory, 0, {}, false, ""});
+    for (unsigned seed = 1; seed <= 16; seed++) {
+        char name[32];
+        snprintf(name, sizeof(name), "incremental %u", seed);
+        tests.push_back({name, CASE_INCREMENTAL, "", seed, {}, false, ""});
+    }
+    tests.push_back({"link", CASE_LINK, std::string(directory) + "/link", 0,
+                     {}, false, ""});
+    tests.push_back({"objects", CASE_OBJECT, "", 0, {}, false, ""});
+    tests.push_back({"cache", CASE_CACHE, "", 0, {}, false, ""});
+    tests.push_back({"server", CASE_SERVER, "", 0, {}, false, ""});
+    for (unsigned seed = 0; seed < 4; seed++) {
+        char name[32];
+        snprintf(name, sizeof(name), "parallel %u", seed);
+        tests.push_back({name, CASE_PARALLEL, "", seed, {}, false, ""});
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    std::atomic<size_t> next(0);
+    if ((size_t)threads > tests.size())
+        threads = tests.size();
+    if (threads < 1)
+        threads = 1;
+    IncludeCache includes;
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) {
+        pool.emplace_back(worker, &tests, &next, &includes);
+    }
+    worker(&tests, &next, &includes);
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - begin)
+                         .count();
+
+    int failed = 0;
+    for (const TestCase &test : tests) {
+        if (!test.passed) {
+            failed++;
+            printf("FAIL %s\n%s", test.name.c_str(), test.report.c_str());
+        } else if (verbose) {
+            printf("ok   %s\n", test.name.c_str());
+        }
+    }
+    printf("%zu golden, %zu error and %d generated cases, all opcodes, a "
+           "batch, incremental edits, linking, objects, the cache, the server "
+           "and threads, %d failed in %.1f ms on %d threads\n",
+           golden, errors, generated, failed, seconds * 1e3, threads);
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,166 @@
+// Disassembles ROMs into sources for ch8asm (see disassembler.h), each
+// NAME.ch8 into NAME.asm next to it, or a single ROM into -o source ("-"
+// for standard output). With --check every source is assembled again and
+// has to give back its ROM byte for byte.
+//   ch8dis.x [-j threads] [--check] [-o source] roms...
+
+#include <atomic>
+#include <chrono>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/assembler.h"
+#include "../src/disassembler.h"
+#include "../src/io.h"
+
+typedef enum {
+    DIS_OK,
+    DIS_READ_ERROR,
+    DIS_WRITE_ERROR,
+    DIS_CHECK_ERROR,
+} DisResult;
+
+typedef struct {
+    std::string rom;
+    std::string source;
+    DisResult result;
+} DisJob;
+
+// the extension of the file name, if any, is replaced
+static std::string sourceName(const std::string &rom) {
+    size_t slash = rom.rfind('/');
+    size_t dot = rom.rfind('.');
+    if (dot == std::string::npos ||
+        (slash != std::string::npos && dot < slash))
+        return rom + ".asm";
+    return rom.substr(0, dot) + ".asm";
+}
+
+static DisResult disassembleJob(Assembler *assembler, bool check,
+                                const DisJob &job) {
+    SourceFile rom;
+    if (!openSource(job.rom.c_str(), &rom))
+        return DIS_READ_ERROR;
+    std::string source;
+    disassemble(rom.data, rom.length, &source);
+
+    // written either way, a source that fails the check shows why
+    DisResult result = DIS_OK;
+    if (!writeRom(job.source.c_str(), source.data(), source.size())) {
+        result = DIS_WRITE_ERROR;
+    } else if (check) {
+        Output output;
+        Diagnostics diagnostics;
+        if (assembler->assemble(source.data(), source.size(), &output,
+                                &diagnostics) != ASSEMBLE_OK ||
+            output.length != rom.length ||
+            memcmp(output.data, rom.data, rom.length) != 0)
+            result = DIS_CHECK_ERROR;
+    }
+    closeSource(&rom);
+    return result;
+}
+
+static void worker(std::vector<DisJob> *jobs, std::atomic<size_t> *next,
+                   bool check) {
+    Assembler assembler;
+    size_t i;
+    while ((i = next->fetch_add(1, std::memory_order_relaxed)) <
+           jobs->size()) {
+        DisJob *job = &(*jobs)[i];
+        job->result = disassembleJob(&assembler, check, *job);
+    }
+}
+
+static void usage() {
+    fprintf(stderr,
+            "Usage: ch8dis [-j threads] [--check] [-o source] roms...\n");
+    exit(64);
+}
+
+// a positive count, anything else is a usage error
+static int parseThreads(const char *text) {
+    char *end;
+    errno = 0;
+    long threads = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || threads < 1 ||
+        threads > INT_MAX)
+        usage();
+    return threads;
+}
+
+int main(int argc, char *argv[]) {
+    int threads = std::thread::hardware_concurrency();
+    bool check = false;
+    const char *outfile = nullptr;
+    std::vector<DisJob> jobs;
+    for (int arg = 1; arg < argc; arg++) {
+        if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc) {
+            threads = parseThreads(argv[++arg]);
+        } else if (strcmp(argv[arg], "--check") == 0) {
+            check = true;
+        } else if (strcmp(argv[arg], "-o") == 0 && arg + 1 < argc) {
+            outfile = argv[++arg];
+        } else if (argv[arg][0] == '-' && argv[arg][1] != '\0') {
+            usage();
+        } else {
+            jobs.push_back({argv[arg], sourceName(argv[arg]), DIS_OK});
+        }
+    }
+    if (jobs.empty() || (outfile != nullptr && jobs.size() != 1)) {
+        usage();
+    }
+    if (outfile != nullptr) {
+        jobs[0].source = outfile;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    std::atomic<size_t> next(0);
+    if ((size_t)threads > jobs.size())
+        threads = jobs.size();
+    if (threads < 1)
+        threads = 1;
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) {
+        pool.emplace_back(worker, &jobs, &next, check);
+    }
+    worker(&jobs, &next, check);
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - begin)
+                         .count();
+
+    int failed = 0;
+    for (const DisJob &job : jobs) {
+        switch (job.result) {
+            case DIS_OK:
+                break;
+            case DIS_READ_ERROR:
+                fprintf(stderr, "Could not read file \"%s\".\n",
+                        job.rom.c_str());
+                break;
+            case DIS_WRITE_ERROR:
+                fprintf(stderr, "Could not write file \"%s\".\n",
+                        job.source.c_str());
+                break;
+            case DIS_CHECK_ERROR:
+                fprintf(stderr, "\"%s\" does not assemble back to \"%s\".\n",
+                        job.source.c_str(), job.rom.c_str());
+                break;
+        }
+        failed += job.result != DIS_OK;
+    }
+    if (jobs.size() > 1) {
+        fprintf(stderr, "%zu ROMs (%d failed) in %.3f s on %d threads\n",
+                jobs.size(), failed, seconds, threads);
+    }
+    return failed > 0 ? 65 : 0;
+}
@@ -0,0 +1,63 @@
+// Links objects from `ch8asm -c` into a ROM. Modules are placed from 0x200
+// on in the order they are given, so the first one holds the entry point.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "../src/diagnostics.h"
+#include "../src/io.h"
+#include "../src/object.h"
+
+static void usage() {
+    fprintf(stderr, "Usage: ch8link [-o rom] [objects...]\n");
+    exit(64);
+}
+
+int main(int argc, char *argv[]) {
+    const char *outfile = "out.bin";
+    std::vector<std::string> names;
+    for (int arg = 1; arg < argc; arg++) {
+        if (strcmp(argv[arg], "-o") == 0 && arg + 1 < argc) {
+            outfile = argv[++arg];
+        } else if (argv[arg][0] == '-' && argv[arg][1] != '\0') {
+            usage();
+        } else {
+            names.push_back(argv[arg]);
+        }
+    }
+    if (names.empty()) {
+        usage();
+    }
+
+    std::vector<ObjectFile> modules(names.size());
+    for (size_t i = 0; i < names.size(); i++) {
+        SourceFile file;
+        if (!openSource(names[i].c_str(), &file)) {
+            fprintf(stderr, "Could not read file \"%s\".\n", names[i].c_str());
+            exit(74);
+        }
+        bool ok = decodeObject(file.data, file.length, &modules[i]);
+        closeSource(&file);
+        if (!ok) {
+            fprintf(stderr, "File \"%s\" is not an object.\n",
+                    names[i].c_str());
+            exit(65);
+        }
+    }
+
+    std::vector<char> rom;
+    Diagnostics diagnostics;
+    if (!link(modules, names, &rom, &diagnostics)) {
+        diagnostics.print(stderr);
+        fprintf(stderr, "Linking failed.\n");
+        exit(65);
+    }
+    if (!writeRom(outfile, rom.data(), rom.size())) {
+        fprintf(stderr, "Could not write file \"%s\".\n", outfile);
+        exit(74);
+    }
+    exit(0);
+}